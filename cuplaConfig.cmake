@@ -110,6 +110,10 @@ else()
     list(APPEND _cupla_COMPILE_DEFINITIONS_PUBLIC ${alpaka_COMPILE_DEFINITIONS})
     list(APPEND _cupla_INCLUDE_DIRECTORIES_PUBLIC ${alpaka_INCLUDE_DIRS})
     list(APPEND _cupla_LINK_LIBRARIES_PUBLIC ${alpaka_LIBRARIES})
+    # the typed memsets (cuplaMemsetD16, ...) use the CUDA driver API
+    if(ALPAKA_ACC_GPU_CUDA_ENABLE)
+        list(APPEND _cupla_LINK_LIBRARIES_PUBLIC ${CUDA_CUDA_LIBRARY})
+    endif()
 endif()
 
 
@@ -147,6 +151,16 @@ set(_cupla_INCLUDE_DIR "${_cupla_ROOT_DIR}/include")
 list(APPEND _cupla_INCLUDE_DIRECTORIES_PUBLIC ${_cupla_INCLUDE_DIR})
 set(_cupla_SUFFIXED_INCLUDE_DIR "${_cupla_INCLUDE_DIR}")
 
+OPTION(CUPLA_API_PER_THREAD_DEFAULT_STREAM "Use a separate default stream for each host thread" OFF)
+if(CUPLA_API_PER_THREAD_DEFAULT_STREAM)
+    list(APPEND _cupla_COMPILE_DEFINITIONS_PUBLIC "CUPLA_API_PER_THREAD_DEFAULT_STREAM=1")
+endif()
+
+OPTION(CUPLA_STREAM_CPU_POOL "Execute the streams of CPU accelerators by a shared pool of threads" ON)
+if(NOT CUPLA_STREAM_CPU_POOL)
+    list(APPEND _cupla_COMPILE_DEFINITIONS_PUBLIC "CUPLA_STREAM_CPU_POOL=0")
+endif()
+
 set(_cupla_SOURCE_DIR "${_cupla_ROOT_DIR}/src")
 list(APPEND _cupla_SOURCE_DIRECTORIES_PUBLIC ${_cupla_SOURCE_DIR})
 set(_cupla_SUFFIXED_SOURCE_DIR "${_cupla_SOURCE_DIR}")
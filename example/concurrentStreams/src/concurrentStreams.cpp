@@ -0,0 +1,164 @@
+/**
+ * Copyright 2016 Rene Widera
+ *
+ * This file is part of cupla.
+ *
+ * cupla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cupla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cupla.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+/* Concurrent use of the host API from several host threads
+ *
+ * Each host thread repeatedly creates a stream and an event, allocates
+ * device memory with cudaMalloc and cudaMallocAsync, fills it with kernels
+ * and copies, waits for the event, checks the result and releases all
+ * resources again. The threads share the default device.
+ *
+ * usage: ./concurrentStreams [numThreads] [iterations]
+ */
+
+#include <cuda_to_cupla.hpp>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+/** print a failed call and leave the calling function with false */
+#define CHECK(cmd)                                                             \
+    do                                                                         \
+    {                                                                          \
+        cudaError_t const error = cmd;                                         \
+        if( error != cudaSuccess )                                             \
+        {                                                                      \
+            printf(                                                            \
+                "%s:%d: %s failed: %s\n",                                      \
+                __FILE__, __LINE__, #cmd, cudaGetErrorString( error )          \
+            );                                                                 \
+            return false;                                                      \
+        }                                                                      \
+    } while( 0 )
+
+struct add_kernel
+{
+
+template<
+    typename T_Acc
+>
+ALPAKA_FN_ACC
+void operator()(T_Acc const & acc, int *data, int value, int n) const
+{
+    int idx = blockIdx.x * blockDim.x + threadIdx.x;
+    if( idx < n )
+        data[idx] += value;
+}
+};
+
+/** run all iterations of one host thread
+ *
+ * @return true if all results are correct and no call failed
+ */
+bool
+runThread( int const threadId, int const iterations )
+{
+    int const n = 4096;
+    size_t const nbytes = n * sizeof( int );
+    dim3 const threads( 64 );
+    dim3 const blocks( n / threads.x );
+
+    std::vector< int > result( n );
+
+    for( int i = 0; i < iterations; ++i )
+    {
+        int const value = threadId * iterations + i;
+
+        cudaStream_t stream;
+        CHECK( cudaStreamCreateWithFlags( &stream, cudaStreamNonBlocking ) );
+        cudaEvent_t done;
+        CHECK( cudaEventCreateWithFlags( &done, cudaEventDisableTiming ) );
+
+        int *d_a = nullptr;
+        CHECK( cudaMalloc( (void **)&d_a, nbytes ) );
+        CHECK( cudaMemsetAsync( d_a, 0, nbytes, stream ) );
+        CUPLA_KERNEL(add_kernel)(blocks, threads, 0, stream)(d_a, value, n);
+
+        // stream ordered temporary buffer
+        int *d_tmp = nullptr;
+        CHECK( cudaMallocAsync( (void **)&d_tmp, nbytes, stream ) );
+        CHECK( cudaMemcpyAsync( d_tmp, d_a, nbytes, cudaMemcpyDeviceToDevice, stream ) );
+        CUPLA_KERNEL(add_kernel)(blocks, threads, 0, stream)(d_tmp, 1, n);
+        CHECK( cudaMemcpyAsync( result.data(), d_tmp, nbytes, cudaMemcpyDeviceToHost, stream ) );
+        CHECK( cudaFreeAsync( d_tmp, stream ) );
+
+        CHECK( cudaEventRecord( done, stream ) );
+        CHECK( cudaEventSynchronize( done ) );
+
+        for( int j = 0; j < n; ++j )
+            if( result[ j ] != value + 1 )
+            {
+                printf(
+                    "Error! thread %d iteration %d: data[%d] = %d, ref = %d\n",
+                    threadId, i, j, result[ j ], value + 1
+                );
+                return false;
+            }
+
+        CHECK( cudaFree( d_a ) );
+        CHECK( cudaEventDestroy( done ) );
+        CHECK( cudaStreamDestroy( stream ) );
+    }
+    return true;
+}
+
+int main( int argc, char *argv[] )
+{
+    int const numThreads = argc > 1 ? atoi( argv[ 1 ] ) : 8;
+    int const iterations = argc > 2 ? atoi( argv[ 2 ] ) : 100;
+    if( numThreads <= 0 || iterations <= 0 )
+    {
+        printf( "usage: %s [numThreads] [iterations]\n", argv[ 0 ] );
+        return EXIT_FAILURE;
+    }
+
+    printf(
+        "[%s] - %d threads, %d iterations\n",
+        argv[ 0 ], numThreads, iterations
+    );
+
+    std::atomic< int > numFailed( 0 );
+    std::vector< std::thread > threads;
+    for( int t = 0; t < numThreads; ++t )
+        threads.emplace_back(
+            [ t, iterations, &numFailed ]( )
+            {
+                if( !runThread( t, iterations ) )
+                    ++numFailed;
+            }
+        );
+    for( auto & thread : threads )
+        thread.join( );
+
+    cudaDeviceReset();
+
+    if( numFailed.load( ) != 0 )
+    {
+        printf( "%d of %d threads failed\n", numFailed.load( ), numThreads );
+        return EXIT_FAILURE;
+    }
+    printf( "all threads passed\n" );
+    return EXIT_SUCCESS;
+}
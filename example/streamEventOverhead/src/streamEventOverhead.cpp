@@ -0,0 +1,170 @@
+/**
+ * Copyright 2016 Rene Widera
+ *
+ * This file is part of cupla.
+ *
+ * cupla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cupla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cupla.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+/* Overhead of kernel launches and of the stream and event handling
+ *
+ * `numLive` streams and events are kept alive during the measurement, all
+ * handles are looked up in populated handle tables. The operations use the
+ * live streams and events round robin. Measured is the average time of
+ *   - enqueuing an empty kernel
+ *   - recording an event and querying it until it is done
+ *   - recording an event and waiting for it with cudaEventSynchronize
+ *   - creating and destroying a stream
+ *   - creating and destroying an event
+ *
+ * The numbers are absolute, to compare two versions of cupla build the
+ * example against both.
+ *
+ * usage: ./streamEventOverhead [iterations] [numLive]
+ */
+
+#include <cuda_to_cupla.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#define CHECK(cmd)                                                             \
+    do                                                                         \
+    {                                                                          \
+        cudaError_t const error = cmd;                                         \
+        if( error != cudaSuccess )                                             \
+        {                                                                      \
+            printf(                                                            \
+                "%s:%d: %s failed: %s\n",                                      \
+                __FILE__, __LINE__, #cmd, cudaGetErrorString( error )          \
+            );                                                                 \
+            exit( EXIT_FAILURE );                                              \
+        }                                                                      \
+    } while( 0 )
+
+struct empty_kernel
+{
+
+template<
+    typename T_Acc
+>
+ALPAKA_FN_ACC
+void operator()(T_Acc const &, int) const
+{
+}
+};
+
+using Clock = std::chrono::steady_clock;
+
+/** average time in microseconds of one of `iterations` runs */
+double
+average( Clock::time_point const start, int const iterations )
+{
+    std::chrono::duration< double, std::micro > const total =
+        Clock::now( ) - start;
+    return total.count( ) / iterations;
+}
+
+int main( int argc, char *argv[] )
+{
+    int const iterations = argc > 1 ? atoi( argv[ 1 ] ) : 10000;
+    int const numLive = argc > 2 ? atoi( argv[ 2 ] ) : 256;
+    if( iterations <= 0 || numLive <= 0 )
+    {
+        printf( "usage: %s [iterations] [numLive]\n", argv[ 0 ] );
+        return EXIT_FAILURE;
+    }
+
+    printf(
+        "[%s] - %d iterations, %d live streams and events\n",
+        argv[ 0 ], iterations, numLive
+    );
+
+    std::vector< cudaStream_t > streams( numLive );
+    std::vector< cudaEvent_t > events( numLive );
+    for( int i = 0; i < numLive; ++i )
+    {
+        CHECK( cudaStreamCreate( &streams[ i ] ) );
+        CHECK( cudaEventCreateWithFlags( &events[ i ], cudaEventDisableTiming ) );
+    }
+
+    // warm up, creates the stream workers and the event pools
+    for( int i = 0; i < numLive; ++i )
+        CHECK( cudaEventRecord( events[ i ], streams[ i ] ) );
+    CHECK( cudaDeviceSynchronize( ) );
+
+    Clock::time_point start = Clock::now( );
+    for( int i = 0; i < iterations; ++i )
+        CUPLA_KERNEL(empty_kernel)(dim3( 1 ), dim3( 1 ), 0, streams[ i % numLive ])(i);
+    double const launchTime = average( start, iterations );
+    CHECK( cudaGetLastError( ) );
+    CHECK( cudaDeviceSynchronize( ) );
+    double const launchSyncTime = average( start, iterations );
+    printf( "kernel launch:              %10.3f us\n", launchTime );
+    printf( "kernel launch + execution:  %10.3f us\n", launchSyncTime );
+
+    start = Clock::now( );
+    for( int i = 0; i < iterations; ++i )
+    {
+        int const idx = i % numLive;
+        CHECK( cudaEventRecord( events[ idx ], streams[ idx ] ) );
+        cudaError_t state;
+        while( ( state = cudaEventQuery( events[ idx ] ) ) == cudaErrorNotReady )
+            ;
+        CHECK( state );
+    }
+    printf( "event record + query:       %10.3f us\n", average( start, iterations ) );
+
+    start = Clock::now( );
+    for( int i = 0; i < iterations; ++i )
+    {
+        int const idx = i % numLive;
+        CHECK( cudaEventRecord( events[ idx ], streams[ idx ] ) );
+        CHECK( cudaEventSynchronize( events[ idx ] ) );
+    }
+    printf( "event record + synchronize: %10.3f us\n", average( start, iterations ) );
+
+    start = Clock::now( );
+    for( int i = 0; i < iterations; ++i )
+    {
+        cudaStream_t tmpStream;
+        CHECK( cudaStreamCreate( &tmpStream ) );
+        CHECK( cudaStreamDestroy( tmpStream ) );
+    }
+    printf( "stream create + destroy:    %10.3f us\n", average( start, iterations ) );
+
+    start = Clock::now( );
+    for( int i = 0; i < iterations; ++i )
+    {
+        cudaEvent_t tmpEvent;
+        CHECK( cudaEventCreateWithFlags( &tmpEvent, cudaEventDisableTiming ) );
+        CHECK( cudaEventDestroy( tmpEvent ) );
+    }
+    printf( "event create + destroy:     %10.3f us\n", average( start, iterations ) );
+
+    for( int i = 0; i < numLive; ++i )
+    {
+        CHECK( cudaEventDestroy( events[ i ] ) );
+        CHECK( cudaStreamDestroy( streams[ i ] ) );
+    }
+
+    cudaDeviceReset();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,227 @@
+/**
+ * Copyright 2016 Rene Widera
+ *
+ * This file is part of cupla.
+ *
+ * cupla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cupla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cupla.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+/* Latency of prioritized work under background load
+ *
+ * Several background streams with the least priority are filled with long
+ * running kernels. While they are busy a control stream launches short
+ * kernels one by one, the latency from the launch to the end of each
+ * control kernel is measured on the host. The measurement is executed with
+ * a control stream of the least and of the greatest priority, p50 and p99
+ * of the latencies are reported for both.
+ *
+ * usage: ./streamPriority [numBackgroundStreams] [kernelsPerStream]
+ */
+
+#include <cuda_to_cupla.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#define CHECK(cmd)                                                             \
+    do                                                                         \
+    {                                                                          \
+        cudaError_t const error = cmd;                                         \
+        if( error != cudaSuccess )                                             \
+        {                                                                      \
+            printf(                                                            \
+                "%s:%d: %s failed: %s\n",                                      \
+                __FILE__, __LINE__, #cmd, cudaGetErrorString( error )          \
+            );                                                                 \
+            exit( EXIT_FAILURE );                                              \
+        }                                                                      \
+    } while( 0 )
+
+struct busy_kernel
+{
+
+template<
+    typename T_Acc
+>
+ALPAKA_FN_ACC
+void operator()(T_Acc const & acc, float *data, int iterations) const
+{
+    int idx = blockIdx.x * blockDim.x + threadIdx.x;
+    float v = data[idx];
+    for( int i = 0; i < iterations; ++i )
+        v = v * 0.999f + 0.001f;
+    data[idx] = v;
+}
+};
+
+using Clock = std::chrono::steady_clock;
+
+struct Config
+{
+    int numBackground;
+    int kernelsPerStream;
+    int leastPriority;
+};
+
+/** latencies in microseconds of control kernels launched while the
+ *  background streams are busy
+ */
+std::vector< double >
+measure( Config const & config, int const controlPriority )
+{
+    int const n = 64 * 1024;
+    size_t const nbytes = n * sizeof( float );
+    dim3 const threads( 64 );
+    dim3 const blocks( n / threads.x );
+    int const backgroundIterations = 1000;
+    int const controlIterations = 10;
+
+    std::vector< cudaStream_t > background( config.numBackground );
+    std::vector< cudaEvent_t > backgroundDone( config.numBackground );
+    std::vector< float * > buffers( config.numBackground, nullptr );
+    for( int s = 0; s < config.numBackground; ++s )
+    {
+        CHECK( cudaStreamCreateWithPriority(
+            &background[ s ],
+            cudaStreamNonBlocking,
+            config.leastPriority
+        ) );
+        CHECK( cudaEventCreateWithFlags( &backgroundDone[ s ], cudaEventDisableTiming ) );
+        CHECK( cudaMalloc( (void **)&buffers[ s ], nbytes ) );
+        CHECK( cudaMemset( buffers[ s ], 0, nbytes ) );
+    }
+
+    cudaStream_t control;
+    CHECK( cudaStreamCreateWithPriority(
+        &control,
+        cudaStreamNonBlocking,
+        controlPriority
+    ) );
+    cudaEvent_t controlDone;
+    CHECK( cudaEventCreateWithFlags( &controlDone, cudaEventDisableTiming ) );
+    float * controlBuffer = nullptr;
+    CHECK( cudaMalloc( (void **)&controlBuffer, threads.x * sizeof( float ) ) );
+    CHECK( cudaMemset( controlBuffer, 0, threads.x * sizeof( float ) ) );
+
+    for( int s = 0; s < config.numBackground; ++s )
+    {
+        for( int k = 0; k < config.kernelsPerStream; ++k )
+            CUPLA_KERNEL(busy_kernel)(blocks, threads, 0, background[ s ])(buffers[ s ], backgroundIterations);
+        CHECK( cudaEventRecord( backgroundDone[ s ], background[ s ] ) );
+    }
+
+    // only samples taken while all background streams are busy are used
+    auto const isLoaded = [ & ]( ) -> bool
+    {
+        for( auto const & event : backgroundDone )
+        {
+            cudaError_t const state = cudaEventQuery( event );
+            if( state == cudaSuccess )
+                return false;
+            if( state != cudaErrorNotReady )
+                CHECK( state );
+        }
+        return true;
+    };
+
+    std::vector< double > latencies;
+    while( isLoaded( ) )
+    {
+        Clock::time_point const start = Clock::now( );
+        CUPLA_KERNEL(busy_kernel)(dim3( 1 ), threads, 0, control)(controlBuffer, controlIterations);
+        CHECK( cudaEventRecord( controlDone, control ) );
+        CHECK( cudaEventSynchronize( controlDone ) );
+        std::chrono::duration< double, std::micro > const latency =
+            Clock::now( ) - start;
+        if( isLoaded( ) )
+            latencies.push_back( latency.count( ) );
+    }
+
+    CHECK( cudaDeviceSynchronize( ) );
+    for( int s = 0; s < config.numBackground; ++s )
+    {
+        CHECK( cudaFree( buffers[ s ] ) );
+        CHECK( cudaEventDestroy( backgroundDone[ s ] ) );
+        CHECK( cudaStreamDestroy( background[ s ] ) );
+    }
+    CHECK( cudaFree( controlBuffer ) );
+    CHECK( cudaEventDestroy( controlDone ) );
+    CHECK( cudaStreamDestroy( control ) );
+
+    return latencies;
+}
+
+//! percentile of sorted values, `p` in [0;100]
+double
+percentile( std::vector< double > const & sorted, int const p )
+{
+    return sorted[ ( sorted.size( ) - 1u ) * p / 100u ];
+}
+
+void
+report( char const * const name, std::vector< double > latencies )
+{
+    if( latencies.empty( ) )
+    {
+        printf( "%-18s no samples, increase kernelsPerStream\n", name );
+        return;
+    }
+    std::sort( latencies.begin( ), latencies.end( ) );
+    printf(
+        "%-18s samples %6zu   p50 %12.1f us   p99 %12.1f us\n",
+        name,
+        latencies.size( ),
+        percentile( latencies, 50 ),
+        percentile( latencies, 99 )
+    );
+}
+
+int main( int argc, char *argv[] )
+{
+    // more background streams than the host or device executes at once
+    Config config;
+    config.numBackground = argc > 1 ?
+        atoi( argv[ 1 ] ) :
+        std::max( 8, 2 * static_cast< int >( std::thread::hardware_concurrency( ) ) );
+    config.kernelsPerStream = argc > 2 ? atoi( argv[ 2 ] ) : 64;
+    if( config.numBackground <= 0 || config.kernelsPerStream <= 0 )
+    {
+        printf( "usage: %s [numBackgroundStreams] [kernelsPerStream]\n", argv[ 0 ] );
+        return EXIT_FAILURE;
+    }
+
+    int greatestPriority = 0;
+    CHECK( cudaDeviceGetStreamPriorityRange( &config.leastPriority, &greatestPriority ) );
+    printf(
+        "[%s] - %d background streams, priorities: least %d, greatest %d\n",
+        argv[ 0 ], config.numBackground, config.leastPriority, greatestPriority
+    );
+
+    report( "least priority", measure( config, config.leastPriority ) );
+    if( greatestPriority != config.leastPriority )
+        report( "greatest priority", measure( config, greatestPriority ) );
+    else
+        printf( "stream priorities are not supported by the device\n" );
+
+    cudaDeviceReset();
+
+    return EXIT_SUCCESS;
+}
@@ -32,9 +32,9 @@ const char *
 cuplaGetErrorString(cuplaError_t);
 
 
-/** not supported
+/** error of the last kernel launch of the calling host thread
  *
- * @return always cuplaSuccess
+ * The error is reset to cuplaSuccess.
  */
 cuplaError_t
 cuplaGetLastError();
@@ -45,6 +45,27 @@ cuplaDeviceReset( );
 cuplaError_t
 cuplaDeviceSynchronize( );
 
+/** get the stream priorities of the current device
+ *
+ * A lower number is a higher priority. Backends without stream priorities
+ * report 0 for both.
+ *
+ * @param leastPriority lowest priority, can be nullptr
+ * @param greatestPriority highest priority, can be nullptr
+ */
+cuplaError_t
+cuplaDeviceGetStreamPriorityRange(
+    int * leastPriority,
+    int * greatestPriority
+);
+
+/** get the free and total memory of the current device
+ *
+ * If a capacity is set with cuplaMemSetCapacity() or the environment
+ * variable `CUPLA_MEM_CAPACITY` the capacity is reported as total memory and
+ * the free memory is limited to the capacity minus the bytes in use. Cached
+ * memory is counted as free.
+ */
 cuplaError_t
 cuplaMemGetInfo(
     size_t * free,
@@ -41,12 +41,98 @@ cuplaMalloc(
     size_t size
 );
 
+/** allocate device memory
+ *
+ * @param flags cuplaMallocDefault or a combination of one huge page flag
+ *              (cuplaMallocHugePages, cuplaMallocNoHugePages) and one NUMA
+ *              flag (cuplaMallocNuma*), both are only used for CPU
+ *              accelerators
+ */
+cuplaError_t
+cuplaMallocWithFlags(
+    void **ptrptr,
+    size_t size,
+    unsigned int flags
+);
+
+/** allocate zero filled device memory
+ *
+ * On CPU accelerators the memory is mapped from fresh demand zero pages,
+ * physical memory is only used for pages which are touched. On CUDA devices
+ * a cuplaMemset() to zero at the base pointer is skipped as long as the
+ * memory was not written by a kernel, copy or memset. CPU accelerators
+ * always execute the memset, the host can write to their memory directly.
+ */
+cuplaError_t
+cuplaMallocZeroed(
+    void **ptrptr,
+    size_t size
+);
+
+/** allocate device memory stream ordered
+ *
+ * Memory released with cuplaFreeAsync() to the same stream is reused without
+ * synchronization.
+ */
+cuplaError_t
+cuplaMallocAsync(
+    void **ptrptr,
+    size_t size,
+    cuplaStream_t stream = 0
+);
+
 cuplaError_t
 cuplaMallocHost(
     void **ptrptr,
     size_t size
 );
 
+/** allocate host memory
+ *
+ * @param flags cuplaHostAllocDefault or a combination of
+ *              cuplaHostAllocPortable, cuplaHostAllocMapped and
+ *              cuplaHostAllocWriteCombined, can be combined with the huge
+ *              page flags of cuplaMallocWithFlags
+ */
+cuplaError_t
+cuplaHostAlloc(
+    void **ptrptr,
+    size_t size,
+    unsigned int flags
+);
+
+/** get the device pointer of mapped host memory
+ *
+ * On CPU accelerators the device pointer is equal to the host pointer and
+ * no copy is needed to access the memory within a kernel.
+ */
+cuplaError_t
+cuplaHostGetDevicePointer(
+    void **pDevice,
+    void *pHost,
+    unsigned int flags
+);
+
+/** register memory owned by the application as host memory
+ *
+ * The memory can be used like memory allocated with cuplaHostAlloc() until
+ * it is unregistered, on CPU accelerators also as device memory.
+ *
+ * @param flags cuplaHostRegisterDefault or a combination of
+ *              cuplaHostRegisterPortable, cuplaHostRegisterMapped,
+ *              cuplaHostRegisterIoMemory and cuplaHostRegisterReadOnly
+ */
+cuplaError_t
+cuplaHostRegister(
+    void *ptr,
+    size_t size,
+    unsigned int flags
+);
+
+//! unregister memory registered with cuplaHostRegister()
+cuplaError_t
+cuplaHostUnregister( void *ptr );
+
 
 cuplaError_t
 cuplaMallocPitch(
@@ -85,12 +171,127 @@ make_cuplaPitchedPtr(
     size_t const ysz
 );
 
+/** release device memory
+ *
+ * Blocks until all streams of the current device are finished, use
+ * cuplaFreeAsync to release memory without synchronization.
+ */
 cuplaError_t
 cuplaFree(void *ptr);
 
+//! release host memory, blocks until all streams of all devices are finished
 cuplaError_t
 cuplaFreeHost(void *ptr);
 
+/** release device memory stream ordered
+ *
+ * The memory can be used by work enqueued into `stream` before the call.
+ */
+cuplaError_t
+cuplaFreeAsync(
+    void *ptr,
+    cuplaStream_t stream = 0
+);
+
+/** query the allocation a pointer belongs to
+ *
+ * Interior pointers are resolved to their allocation. Pointers not
+ * allocated by cupla are reported as cuplaMemoryTypeUnregistered.
+ */
+cuplaError_t
+cuplaPointerGetAttributes(
+    cuplaPointerAttributes * attributes,
+    void const * ptr
+);
+
+/** set the maximal number of bytes of freed device memory which is cached
+ *
+ * Cached memory is reused by later allocations of the current device.
+ * The default limit can be set with the environment variable
+ * `CUPLA_MEM_CACHE_LIMIT`.
+ *
+ * @param bytes cache limit in bytes, 0 disables the cache
+ */
+cuplaError_t
+cuplaMemCacheSetLimit( size_t bytes );
+
+/** release cached device memory of the current device
+ *
+ * @param minBytesToKeep number of bytes which can stay in the cache
+ */
+cuplaError_t
+cuplaMemCacheTrim( size_t minBytesToKeep = 0 );
+
+/** set the maximal number of bytes of freed host memory which is cached
+ *
+ * Freed host memory stays pinned (CUDA) or mapped and faulted in (CPU
+ * accelerators) while it is cached. The default limit can be set with the
+ * environment variable `CUPLA_HOST_MEM_CACHE_LIMIT`.
+ *
+ * @param bytes cache limit in bytes, 0 disables the cache
+ */
+cuplaError_t
+cuplaHostMemCacheSetLimit( size_t bytes );
+
+/** release cached host memory
+ *
+ * @param minBytesToKeep number of bytes which can stay in the cache
+ */
+cuplaError_t
+cuplaHostMemCacheTrim( size_t minBytesToKeep = 0 );
+
+//! get the statistics of the host memory pool
+cuplaError_t
+cuplaHostMemGetPoolStats( cuplaMemPoolStats * stats );
+
+/** limit the device memory which can be allocated on the current device
+ *
+ * Live and cached memory count to the capacity, the cache is released
+ * before an allocation fails with cuplaErrorMemoryAllocation. The default
+ * capacity can be set with the environment variable `CUPLA_MEM_CAPACITY`.
+ */
+cuplaError_t
+cuplaMemSetCapacity( size_t bytes );
+
+//! get the statistics of the device memory pool of the current device
+cuplaError_t
+cuplaMemGetPoolStats( cuplaMemPoolStats * stats );
+
+/** set the tag of all following allocations of the calling thread
+ *
+ * The tag is stored by the allocation tracer which is enabled with the
+ * environment variable `CUPLA_ALLOC_TRACE`, nullptr removes the tag.
+ */
+cuplaError_t
+cuplaAllocTraceSetTag( char const * tag );
+
+/** write the allocation trace as JSON
+ *
+ * The trace is also written at cuplaDeviceReset() and at process exit.
+ *
+ * @param fileName file to write, nullptr uses the file of `CUPLA_ALLOC_TRACE`
+ * @return cuplaErrorInvalidValue if the tracer is disabled or the file can
+ *         not be written
+ */
+cuplaError_t
+cuplaAllocTraceDump( char const * fileName = nullptr );
+
+/** set the minimal size in bytes of an allocation backed by huge pages
+ *
+ * Overwrites the environment variable CUPLA_HUGEPAGE_THRESHOLD and affects
+ * new allocations of CPU accelerators only.
+ */
+cuplaError_t
+cuplaMemSetHugePageThreshold( size_t bytes );
+
+/** set the NUMA placement of allocations without a placement flag
+ *
+ * Overwrites the environment variable CUPLA_NUMA_PLACEMENT and affects new
+ * allocations of CPU accelerators only.
+ */
+cuplaError_t
+cuplaMemSetNumaPlacement( enum cuplaNumaPlacement placement );
+
 cuplaError_t
 cuplaMemcpy(
     void *dst,
@@ -108,6 +309,26 @@ cuplaMemcpyAsync(
     cuplaStream_t stream = 0
 );
 
+/** copy a list of independent contiguous memory regions
+ *
+ * All copies are enqueued as one operation into the stream, the arrays can
+ * be reused after the call returns. The memory regions must not overlap.
+ *
+ * @param dsts destination pointer of each copy
+ * @param srcs source pointer of each copy
+ * @param sizes number of bytes of each copy
+ * @param count number of copies
+ */
+cuplaError_t
+cuplaMemcpyBatchAsync(
+    void * const * dsts,
+    void const * const * srcs,
+    size_t const * sizes,
+    size_t count,
+    enum cuplaMemcpyKind kind,
+    cuplaStream_t stream = 0
+);
+
 cuplaError_t
 cuplaMemsetAsync(
     void * devPtr,
@@ -123,6 +344,159 @@ cuplaMemset(
     size_t count
 );
 
+/** set `width` bytes of `height` rows of pitched memory
+ *
+ * The padding between the rows is not written.
+ */
+cuplaError_t
+cuplaMemset2DAsync(
+    void * devPtr,
+    size_t pitch,
+    int value,
+    size_t width,
+    size_t height,
+    cuplaStream_t stream = 0
+);
+
+cuplaError_t
+cuplaMemset2D(
+    void * devPtr,
+    size_t pitch,
+    int value,
+    size_t width,
+    size_t height
+);
+
+/** set the region `extent` (width in bytes) of pitched memory
+ *
+ * The padding between the rows and slices is not written.
+ */
+cuplaError_t
+cuplaMemset3DAsync(
+    cupla::PitchedPtr pitchedDevPtr,
+    int value,
+    cupla::Extent extent,
+    cuplaStream_t stream = 0
+);
+
+cuplaError_t
+cuplaMemset3D(
+    cupla::PitchedPtr pitchedDevPtr,
+    int value,
+    cupla::Extent extent
+);
+
+/** set `count` elements of 16, 32 or 64 bit to value
+ *
+ * devPtr must be aligned to the element size.
+ */
+cuplaError_t
+cuplaMemsetD16Async(
+    void * devPtr,
+    unsigned short value,
+    size_t count,
+    cuplaStream_t stream = 0
+);
+
+cuplaError_t
+cuplaMemsetD16(
+    void * devPtr,
+    unsigned short value,
+    size_t count
+);
+
+/** set `width` elements of 16, 32 or 64 bit in `height` rows of pitched
+ * memory
+ *
+ * devPtr and pitch must be aligned to the element size.
+ */
+cuplaError_t
+cuplaMemsetD2D16Async(
+    void * devPtr,
+    size_t pitch,
+    unsigned short value,
+    size_t width,
+    size_t height,
+    cuplaStream_t stream = 0
+);
+
+cuplaError_t
+cuplaMemsetD2D16(
+    void * devPtr,
+    size_t pitch,
+    unsigned short value,
+    size_t width,
+    size_t height
+);
+
+cuplaError_t
+cuplaMemsetD32Async(
+    void * devPtr,
+    unsigned int value,
+    size_t count,
+    cuplaStream_t stream = 0
+);
+
+cuplaError_t
+cuplaMemsetD32(
+    void * devPtr,
+    unsigned int value,
+    size_t count
+);
+
+cuplaError_t
+cuplaMemsetD2D32Async(
+    void * devPtr,
+    size_t pitch,
+    unsigned int value,
+    size_t width,
+    size_t height,
+    cuplaStream_t stream = 0
+);
+
+cuplaError_t
+cuplaMemsetD2D32(
+    void * devPtr,
+    size_t pitch,
+    unsigned int value,
+    size_t width,
+    size_t height
+);
+
+cuplaError_t
+cuplaMemsetD64Async(
+    void * devPtr,
+    unsigned long long value,
+    size_t count,
+    cuplaStream_t stream = 0
+);
+
+cuplaError_t
+cuplaMemsetD64(
+    void * devPtr,
+    unsigned long long value,
+    size_t count
+);
+
+cuplaError_t
+cuplaMemsetD2D64Async(
+    void * devPtr,
+    size_t pitch,
+    unsigned long long value,
+    size_t width,
+    size_t height,
+    cuplaStream_t stream = 0
+);
+
+cuplaError_t
+cuplaMemsetD2D64(
+    void * devPtr,
+    size_t pitch,
+    unsigned long long value,
+    size_t width,
+    size_t height
+);
+
 cuplaError_t
 cuplaMemcpy2D(
     void * dst,
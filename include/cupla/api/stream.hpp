@@ -33,6 +33,43 @@ cuplaStreamCreate(
     cuplaStream_t * stream
 );
 
+/** create a stream
+ *
+ * @param flags cuplaStreamDefault or cuplaStreamNonBlocking, a non blocking
+ *        stream is not synchronized with the default stream
+ */
+cuplaError_t
+cuplaStreamCreateWithFlags(
+    cuplaStream_t * stream,
+    unsigned int flags
+);
+
+cuplaError_t
+cuplaStreamGetFlags(
+    cuplaStream_t stream,
+    unsigned int * flags
+);
+
+/** create a stream with a priority
+ *
+ * Work of a stream with a higher priority (lower number) is preferred to
+ * work of streams with a lower priority, see
+ * cuplaDeviceGetStreamPriorityRange(). A priority outside of the range is
+ * clamped to the range.
+ */
+cuplaError_t
+cuplaStreamCreateWithPriority(
+    cuplaStream_t * stream,
+    unsigned int flags,
+    int priority
+);
+
+cuplaError_t
+cuplaStreamGetPriority(
+    cuplaStream_t stream,
+    int * priority
+);
+
 cuplaError_t
 cuplaStreamDestroy( cuplaStream_t stream );
 
@@ -28,6 +28,11 @@
 #define cudaErrorMemoryAllocation cuplaErrorMemoryAllocation
 #define cudaErrorInitializationError cuplaErrorInitializationError
 #define cudaErrorNotReady cuplaErrorNotReady
+#define cudaErrorInvalidResourceHandle cuplaErrorInvalidResourceHandle
+#define cudaErrorInvalidValue cuplaErrorInvalidValue
+#define cudaErrorInvalidDevicePointer cuplaErrorInvalidDevicePointer
+#define cudaErrorHostMemoryAlreadyRegistered cuplaErrorHostMemoryAlreadyRegistered
+#define cudaErrorHostMemoryNotRegistered cuplaErrorHostMemoryNotRegistered
 
 #define cudaError_t cuplaError_t
 #define cudaError cuplaError
@@ -36,6 +41,12 @@
 
 #define cudaStream_t cuplaStream_t
 
+#define cudaPointerAttributes cuplaPointerAttributes
+#define cudaMemoryType cuplaMemoryType
+#define cudaMemoryTypeUnregistered cuplaMemoryTypeUnregistered
+#define cudaMemoryTypeHost cuplaMemoryTypeHost
+#define cudaMemoryTypeDevice cuplaMemoryTypeDevice
+
 #define dim3 cupla::dim3
 #define cudaExtent cupla::Extent
 #define cudaPos cupla::Pos
@@ -44,6 +55,24 @@
 
 #define cudaMemcpy3DParms cupla::Memcpy3DParms
 
+/* the stream flags are defines in CUDA therefore we must remove the old
+ * definitions with the cupla enum
+ */
+#ifdef cudaStreamDefault
+#undef cudaStreamDefault
+#endif
+#define cudaStreamDefault cuplaStreamDefault
+
+#ifdef cudaStreamNonBlocking
+#undef cudaStreamNonBlocking
+#endif
+#define cudaStreamNonBlocking cuplaStreamNonBlocking
+
+#ifdef cudaStreamPerThread
+#undef cudaStreamPerThread
+#endif
+#define cudaStreamPerThread cuplaStreamPerThread
+
 #ifdef cudaEventDisableTiming
 #undef cudaEventDisableTiming
 #endif
@@ -52,6 +81,54 @@
  */
 #define cudaEventDisableTiming cuplaEventDisableTiming
 
+/* the host allocation flags are defines in CUDA therefore we must remove
+ * the old definitions with the cupla enum
+ */
+#ifdef cudaHostAllocDefault
+#undef cudaHostAllocDefault
+#endif
+#define cudaHostAllocDefault cuplaHostAllocDefault
+
+#ifdef cudaHostAllocPortable
+#undef cudaHostAllocPortable
+#endif
+#define cudaHostAllocPortable cuplaHostAllocPortable
+
+#ifdef cudaHostAllocMapped
+#undef cudaHostAllocMapped
+#endif
+#define cudaHostAllocMapped cuplaHostAllocMapped
+
+#ifdef cudaHostAllocWriteCombined
+#undef cudaHostAllocWriteCombined
+#endif
+#define cudaHostAllocWriteCombined cuplaHostAllocWriteCombined
+
+#ifdef cudaHostRegisterDefault
+#undef cudaHostRegisterDefault
+#endif
+#define cudaHostRegisterDefault cuplaHostRegisterDefault
+
+#ifdef cudaHostRegisterPortable
+#undef cudaHostRegisterPortable
+#endif
+#define cudaHostRegisterPortable cuplaHostRegisterPortable
+
+#ifdef cudaHostRegisterMapped
+#undef cudaHostRegisterMapped
+#endif
+#define cudaHostRegisterMapped cuplaHostRegisterMapped
+
+#ifdef cudaHostRegisterIoMemory
+#undef cudaHostRegisterIoMemory
+#endif
+#define cudaHostRegisterIoMemory cuplaHostRegisterIoMemory
+
+#ifdef cudaHostRegisterReadOnly
+#undef cudaHostRegisterReadOnly
+#endif
+#define cudaHostRegisterReadOnly cuplaHostRegisterReadOnly
+
 #define sharedMem(ppName, ...)                                                 \
   __VA_ARGS__ &ppName =                                                        \
       ::alpaka::block::shared::st::allocVar<__VA_ARGS__, __COUNTER__>(acc)
@@ -65,6 +142,7 @@
 #define cudaMemcpyDeviceToHost cuplaMemcpyDeviceToHost
 #define cudaMemcpyDeviceToDevice cuplaMemcpyDeviceToDevice
 #define cudaMemcpyHostToHost cuplaMemcpyHostToHost
+#define cudaMemcpyDefault cuplaMemcpyDefault
 
 // index renaming
 #define blockIdx                                                               \
@@ -28,11 +28,17 @@
 #define cudaMallocPitch(...) cuplaMallocPitch(__VA_ARGS__)
 #define cudaMalloc3D(...) cuplaMalloc3D(__VA_ARGS__)
 #define cudaMallocHost(...) cuplaMallocHost(__VA_ARGS__)
+#define cudaMallocAsync(...) cuplaMallocAsync(__VA_ARGS__)
+#define cudaHostAlloc(...) cuplaHostAlloc(__VA_ARGS__)
+#define cudaHostGetDevicePointer(...) cuplaHostGetDevicePointer(__VA_ARGS__)
+#define cudaHostRegister(...) cuplaHostRegister(__VA_ARGS__)
+#define cudaHostUnregister(...) cuplaHostUnregister(__VA_ARGS__)
 
 #define cudaGetErrorString(...) cuplaGetErrorString(__VA_ARGS__)
 
 #define cudaFree(...) cuplaFree(__VA_ARGS__)
 #define cudaFreeHost(...) cuplaFreeHost(__VA_ARGS__)
+#define cudaFreeAsync(...) cuplaFreeAsync(__VA_ARGS__)
 
 #define cudaSetDevice(...) cuplaSetDevice(__VA_ARGS__)
 #define cudaGetDevice(...) cuplaGetDevice(__VA_ARGS__)
@@ -42,6 +48,10 @@
 #define cudaEventDestroy(...) cuplaEventDestroy(__VA_ARGS__)
 
 #define cudaStreamCreate(...) cuplaStreamCreate(__VA_ARGS__)
+#define cudaStreamCreateWithFlags(...) cuplaStreamCreateWithFlags(__VA_ARGS__)
+#define cudaStreamGetFlags(...) cuplaStreamGetFlags(__VA_ARGS__)
+#define cudaStreamCreateWithPriority(...) cuplaStreamCreateWithPriority(__VA_ARGS__)
+#define cudaStreamGetPriority(...) cuplaStreamGetPriority(__VA_ARGS__)
 #define cudaStreamDestroy(...) cuplaStreamDestroy(__VA_ARGS__)
 #define cudaStreamSynchronize(...) cuplaStreamSynchronize(__VA_ARGS__)
 #define cudaStreamWaitEvent(...) cuplaStreamWaitEvent(__VA_ARGS__)
@@ -58,11 +68,16 @@
 #define cudaDeviceReset(...) cuplaDeviceReset(__VA_ARGS__)
 
 #define cudaDeviceSynchronize(...) cuplaDeviceSynchronize(__VA_ARGS__)
+#define cudaDeviceGetStreamPriorityRange(...) cuplaDeviceGetStreamPriorityRange(__VA_ARGS__)
 
 #define cudaGetLastError(...) cuplaGetLastError(__VA_ARGS__)
 
 #define cudaMemset(...) cuplaMemset(__VA_ARGS__)
 #define cudaMemsetAsync(...) cuplaMemsetAsync(__VA_ARGS__)
+#define cudaMemset2D(...) cuplaMemset2D(__VA_ARGS__)
+#define cudaMemset2DAsync(...) cuplaMemset2DAsync(__VA_ARGS__)
+#define cudaMemset3D(...) cuplaMemset3D(__VA_ARGS__)
+#define cudaMemset3DAsync(...) cuplaMemset3DAsync(__VA_ARGS__)
 #define cudaMemcpy2D(...) cuplaMemcpy2D(__VA_ARGS__)
 #define cudaMemcpy2DAsync(...) cuplaMemcpy2DAsync(__VA_ARGS__)
 #define cudaMemcpy3DAsync(...) cuplaMemcpy3DAsync(__VA_ARGS__)
@@ -72,6 +87,8 @@
 
 #define cudaMemGetInfo(...) cuplaMemGetInfo(__VA_ARGS__)
 
+#define cudaPointerGetAttributes(...) cuplaPointerGetAttributes(__VA_ARGS__)
+
 #define make_cudaExtent(...) make_cuplaExtent(__VA_ARGS__)
 #define make_cudaPos(...) make_cuplaPos(__VA_ARGS__)
 
@@ -0,0 +1,134 @@
+/**
+ * Copyright 2016 Rene Widera
+ *
+ * This file is part of cupla.
+ *
+ * cupla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cupla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cupla.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#pragma once
+
+#include <cstddef>
+
+namespace cupla
+{
+namespace detail
+{
+
+    /** plan of a pitched copy with coalesced dimensions
+     *
+     * Dimensions with an extent of one are dropped and a dimension is merged
+     * into its inner neighbor if source and destination rows/slices follow
+     * without gap. After planning a copy is one contiguous block if `m_dim`
+     * is one, else `m_extent[0]` contiguous bytes are copied for each
+     * combination of the outer indices.
+     * Unused dimensions have an extent of one and a pitch of zero.
+     */
+    struct CopyPlan
+    {
+        std::size_t m_dim;
+        //! bytes of a contiguous row followed by the number of rows and slices
+        std::size_t m_extent[ 3 ];
+        std::size_t m_dstPitch[ 3 ];
+        std::size_t m_srcPitch[ 3 ];
+
+        /** create a plan
+         *
+         * @param width bytes to copy per row
+         * @param dstPitch bytes of a row in the destination
+         * @param dstSlicePitch bytes of a slice in the destination
+         */
+        CopyPlan(
+            std::size_t const width,
+            std::size_t const height,
+            std::size_t const depth,
+            std::size_t const dstPitch,
+            std::size_t const dstSlicePitch,
+            std::size_t const srcPitch,
+            std::size_t const srcSlicePitch
+        ) :
+            m_dim( 1u ),
+            m_extent{ width, 1u, 1u },
+            m_dstPitch{ 1u, 0u, 0u },
+            m_srcPitch{ 1u, 0u, 0u }
+        {
+            std::size_t const extent[ 3 ] = { width, height, depth };
+            std::size_t const dPitch[ 3 ] = { 1u, dstPitch, dstSlicePitch };
+            std::size_t const sPitch[ 3 ] = { 1u, srcPitch, srcSlicePitch };
+
+            for( std::size_t d = 1u; d < 3u; ++d )
+            {
+                if( extent[ d ] == 1u )
+                    continue;
+
+                std::size_t const last = m_dim - 1u;
+                std::size_t const dstNext = m_dstPitch[ last ] * m_extent[ last ];
+                std::size_t const srcNext = m_srcPitch[ last ] * m_extent[ last ];
+
+                if( dPitch[ d ] == dstNext && sPitch[ d ] == srcNext )
+                    m_extent[ last ] *= extent[ d ];
+                else
+                {
+                    m_extent[ m_dim ] = extent[ d ];
+                    m_dstPitch[ m_dim ] = dPitch[ d ];
+                    m_srcPitch[ m_dim ] = sPitch[ d ];
+                    ++m_dim;
+                }
+            }
+        }
+
+        //! true if the copy is a single contiguous block
+        bool
+        isContiguous( ) const
+        {
+            return m_dim == 1u;
+        }
+
+        //! number of contiguous rows
+        std::size_t
+        numRows( ) const
+        {
+            return m_extent[ 1 ] * m_extent[ 2 ];
+        }
+
+        //! number of bytes to copy
+        std::size_t
+        bytes( ) const
+        {
+            return m_extent[ 0 ] * numRows( );
+        }
+
+        //! offset of row `row` in the destination
+        std::size_t
+        dstOffset( std::size_t const row ) const
+        {
+            return row % m_extent[ 1 ] * m_dstPitch[ 1 ] +
+                row / m_extent[ 1 ] * m_dstPitch[ 2 ];
+        }
+
+        //! offset of row `row` in the source
+        std::size_t
+        srcOffset( std::size_t const row ) const
+        {
+            return row % m_extent[ 1 ] * m_srcPitch[ 1 ] +
+                row / m_extent[ 1 ] * m_srcPitch[ 2 ];
+        }
+    };
+
+} // namespace detail
+} // namespace cupla
@@ -0,0 +1,165 @@
+/**
+ * Copyright 2016 Rene Widera
+ *
+ * This file is part of cupla.
+ *
+ * cupla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cupla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cupla.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include "cupla/types.hpp"
+
+#include <functional>
+#include <memory>
+#include <utility>
+
+namespace cupla
+{
+namespace detail
+{
+
+    /** functor which is enqueued into a stream and executed by the host
+     *
+     * The task is executed in order with all other work of the stream.
+     */
+    struct HostTask
+    {
+        std::function< void() > m_task;
+
+        HostTask( std::function< void() > task ) :
+            m_task( std::move( task ) )
+        { }
+
+        void
+        operator()() const
+        {
+            m_task();
+        }
+    };
+
+} // namespace detail
+} // namespace cupla
+
+
+namespace alpaka
+{
+namespace stream
+{
+namespace traits
+{
+
+    //! enqueue a host task into the worker thread of an asynchronous stream
+    template<>
+    struct Enqueue<
+        ::alpaka::stream::StreamCpuAsync,
+        ::cupla::detail::HostTask
+    >
+    {
+        ALPAKA_FN_HOST
+        static auto
+        enqueue(
+            ::alpaka::stream::StreamCpuAsync & stream,
+            ::cupla::detail::HostTask const & task
+        )
+        -> void
+        {
+            stream.m_spAsyncStreamCpu->m_workerThread.enqueueTask(
+                [ task ]( )
+                {
+                    task( );
+                }
+            );
+        }
+    };
+
+    //! execute a host task in the calling thread
+    template<>
+    struct Enqueue<
+        ::alpaka::stream::StreamCpuSync,
+        ::cupla::detail::HostTask
+    >
+    {
+        ALPAKA_FN_HOST
+        static auto
+        enqueue(
+            ::alpaka::stream::StreamCpuSync &,
+            ::cupla::detail::HostTask const & task
+        )
+        -> void
+        {
+            task( );
+        }
+    };
+
+#if defined(ALPAKA_ACC_GPU_CUDA_ENABLED)
+    /** enqueue a host task as callback of a CUDA stream
+     *
+     * The callback is executed by a CUDA runtime thread after all preceding
+     * work of the stream is finished, the task must not call the CUDA API.
+     */
+    template<>
+    struct Enqueue<
+        ::alpaka::stream::StreamCudaRtAsync,
+        ::cupla::detail::HostTask
+    >
+    {
+        static void CUDART_CB
+        callback(
+            cudaStream_t,
+            cudaError_t const status,
+            void * const arg
+        )
+        {
+            std::unique_ptr< ::cupla::detail::HostTask > const task(
+                static_cast< ::cupla::detail::HostTask * >( arg )
+            );
+            if( status == cudaSuccess )
+                ( *task )( );
+        }
+
+        ALPAKA_FN_HOST
+        static auto
+        enqueue(
+            ::alpaka::stream::StreamCudaRtAsync & stream,
+            ::cupla::detail::HostTask const & task
+        )
+        -> void
+        {
+            ALPAKA_CUDA_RT_CHECK(
+                cudaSetDevice( stream.m_spStreamImpl->m_dev.m_iDevice )
+            );
+            std::unique_ptr< ::cupla::detail::HostTask > spTask(
+                new ::cupla::detail::HostTask( task )
+            );
+            ALPAKA_CUDA_RT_CHECK(
+                cudaStreamAddCallback(
+                    stream.m_spStreamImpl->m_CudaStream,
+                    callback,
+                    spTask.get( ),
+                    0u
+                )
+            );
+            // owned by the callback
+            spTask.release( );
+        }
+    };
+#endif
+
+} // namespace traits
+} // namespace stream
+} // namespace alpaka
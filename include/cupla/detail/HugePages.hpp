@@ -0,0 +1,150 @@
+/**
+ * Copyright 2016 Rene Widera
+ *
+ * This file is part of cupla.
+ *
+ * cupla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cupla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cupla.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#pragma once
+
+#include "cupla_driver_types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#if defined(__linux__)
+#   include <sys/mman.h>
+#endif
+
+namespace cupla
+{
+namespace detail
+{
+
+    //! size of a huge page on x86_64 and aarch64 (with 4 KiB base pages)
+    constexpr std::size_t hugePageSize = 2u * 1024u * 1024u;
+
+    /** check if transparent huge pages can be requested with madvise */
+    inline auto
+    transparentHugePagesEnabled( )
+    -> bool
+    {
+        static bool const enabled = []( )
+        {
+            char mode[ 64 ] = { 0 };
+            std::FILE * file = std::fopen(
+                "/sys/kernel/mm/transparent_hugepage/enabled",
+                "r"
+            );
+            if( file == nullptr )
+                return false;
+            std::size_t const length = std::fread( mode, 1u, sizeof( mode ) - 1u, file );
+            std::fclose( file );
+            mode[ length ] = '\0';
+            return std::strstr( mode, "[never]" ) == nullptr;
+        }( );
+        return enabled;
+    }
+
+    /** map anonymous memory backed by huge pages
+     *
+     * Explicit huge pages (MAP_HUGETLB) are used if the system provides
+     * them, else the memory is aligned to the huge page size and transparent
+     * huge pages are requested with madvise(MADV_HUGEPAGE).
+     *
+     * @param[in,out] bytes requested size, rounded up to the huge page size
+     * @param[out] type kind of huge pages backing the memory
+     * @return nullptr if no memory could be mapped
+     */
+    inline auto
+    mapHugePages(
+        std::size_t & bytes,
+        cuplaHugePageType & type
+    )
+    -> std::shared_ptr< uint8_t >
+    {
+        type = cuplaHugePageNone;
+#if defined(__linux__)
+        std::size_t const size =
+            ( bytes + hugePageSize - 1u ) / hugePageSize * hugePageSize;
+        auto const unmap = [ size ]( uint8_t * const ptr )
+        {
+            ::munmap( ptr, size );
+        };
+
+#   if defined(MAP_HUGETLB)
+        void * ptr = ::mmap(
+            nullptr,
+            size,
+            PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+            -1,
+            0
+        );
+        if( ptr != MAP_FAILED )
+        {
+            bytes = size;
+            type = cuplaHugePageExplicit;
+            return std::shared_ptr< uint8_t >(
+                static_cast< uint8_t * >( ptr ),
+                unmap
+            );
+        }
+#   endif
+
+        // over allocate to align the memory to the huge page size
+        void * const mapped = ::mmap(
+            nullptr,
+            size + hugePageSize,
+            PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS,
+            -1,
+            0
+        );
+        if( mapped == MAP_FAILED )
+            return nullptr;
+
+        auto const begin = reinterpret_cast< std::uintptr_t >( mapped );
+        std::size_t const head =
+            ( hugePageSize - begin % hugePageSize ) % hugePageSize;
+        auto const aligned = static_cast< uint8_t * >( mapped ) + head;
+        if( head != 0u )
+            ::munmap( mapped, head );
+        ::munmap( aligned + size, hugePageSize - head );
+
+#   if defined(MADV_HUGEPAGE)
+        if(
+            transparentHugePagesEnabled( ) &&
+            ::madvise( aligned, size, MADV_HUGEPAGE ) == 0
+        )
+            type = cuplaHugePageTransparent;
+#   endif
+
+        bytes = size;
+        return std::shared_ptr< uint8_t >( aligned, unmap );
+#else
+        return nullptr;
+#endif
+    }
+
+} // namespace detail
+} // namespace cupla
@@ -0,0 +1,47 @@
+/**
+ * Copyright 2016 Rene Widera
+ *
+ * This file is part of cupla.
+ *
+ * cupla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cupla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cupla.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#pragma once
+
+#include "cupla_driver_types.hpp"
+
+namespace cupla
+{
+namespace detail
+{
+
+    /** error of the last call of the calling host thread which can not
+     *  return an error, e.g. a kernel launch
+     *
+     * Read and reset by cuplaGetLastError().
+     */
+    inline auto
+    lastError()
+    -> cuplaError_t &
+    {
+        static thread_local cuplaError_t error = cuplaSuccess;
+        return error;
+    }
+
+} // namespace detail
+} // namespace cupla
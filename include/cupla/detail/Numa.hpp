@@ -0,0 +1,191 @@
+/**
+ * Copyright 2016 Rene Widera
+ *
+ * This file is part of cupla.
+ *
+ * cupla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cupla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cupla.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#pragma once
+
+#include "cupla_driver_types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#if defined(__linux__)
+#   include <sys/mman.h>
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#endif
+
+namespace cupla
+{
+namespace detail
+{
+
+    /** map anonymous memory
+     *
+     * The pages are not touched, therefore a NUMA policy can be applied
+     * before the memory is placed.
+     *
+     * @param[in,out] bytes requested size, rounded up to the page size
+     * @return nullptr if no memory could be mapped
+     */
+    inline auto
+    mapPages( std::size_t & bytes )
+    -> std::shared_ptr< uint8_t >
+    {
+#if defined(__linux__)
+        std::size_t const pageSize = static_cast< std::size_t >(
+            ::sysconf( _SC_PAGESIZE )
+        );
+        std::size_t const size = ( bytes + pageSize - 1u ) / pageSize * pageSize;
+        void * const ptr = ::mmap(
+            nullptr,
+            size,
+            PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS,
+            -1,
+            0
+        );
+        if( ptr == MAP_FAILED )
+            return nullptr;
+        bytes = size;
+        return std::shared_ptr< uint8_t >(
+            static_cast< uint8_t * >( ptr ),
+            [ size ]( uint8_t * const p )
+            {
+                ::munmap( p, size );
+            }
+        );
+#else
+        return nullptr;
+#endif
+    }
+
+    /** bit mask of all online NUMA nodes
+     *
+     * @return empty vector if the nodes can not be detected
+     */
+    inline auto
+    onlineNumaNodes( )
+    -> std::vector< unsigned long > const &
+    {
+        static std::vector< unsigned long > const nodes = []( )
+        {
+            constexpr std::size_t bitsPerWord = 8u * sizeof( unsigned long );
+            std::vector< unsigned long > mask;
+            std::FILE * file = std::fopen( "/sys/devices/system/node/online", "r" );
+            if( file == nullptr )
+                return mask;
+
+            // format: comma separated list of ranges, e.g. `0-1,4`
+            unsigned long first = 0u;
+            while( std::fscanf( file, "%lu", &first ) == 1 )
+            {
+                unsigned long last = first;
+                int separator = std::fgetc( file );
+                if( separator == '-' )
+                {
+                    if( std::fscanf( file, "%lu", &last ) != 1 )
+                        break;
+                    separator = std::fgetc( file );
+                }
+                for( unsigned long node = first; node <= last; ++node )
+                {
+                    if( mask.size( ) <= node / bitsPerWord )
+                        mask.resize( node / bitsPerWord + 1u, 0u );
+                    mask[ node / bitsPerWord ] |= 1ul << ( node % bitsPerWord );
+                }
+                if( separator != ',' )
+                    break;
+            }
+            std::fclose( file );
+            return mask;
+        }( );
+        return nodes;
+    }
+
+    /** apply a NUMA placement to untouched memory
+     *
+     * On CPU accelerators the device spans all sockets, therefore
+     * cuplaNumaPlacementLocal places the memory on the node of the
+     * allocating thread. cuplaNumaPlacementFirstTouch depends on the
+     * accelerator and is applied by the memory manager.
+     *
+     * @param bytes size of the memory, must be a multiple of the page size
+     * @return placement which was applied
+     */
+    inline auto
+    applyNumaPlacement(
+        uint8_t * const ptr,
+        std::size_t const bytes,
+        cuplaNumaPlacement const placement
+    )
+    -> cuplaNumaPlacement
+    {
+#if defined(__linux__) && defined(SYS_mbind) && defined(SYS_getcpu)
+        // values of linux/mempolicy.h, numaif.h of libnuma is not required
+        constexpr int mpolPreferred = 1;
+        constexpr int mpolInterleave = 3;
+        constexpr std::size_t bitsPerWord = 8u * sizeof( unsigned long );
+
+        std::vector< unsigned long > mask;
+        int mode = 0;
+        if( placement == cuplaNumaPlacementInterleave )
+        {
+            mask = onlineNumaNodes( );
+            mode = mpolInterleave;
+        }
+        else if( placement == cuplaNumaPlacementLocal )
+        {
+            unsigned int cpu = 0u;
+            unsigned int node = 0u;
+            if( ::syscall( SYS_getcpu, &cpu, &node, nullptr ) != 0 )
+                return cuplaNumaPlacementDefault;
+            mask.resize( node / bitsPerWord + 1u, 0u );
+            mask[ node / bitsPerWord ] |= 1ul << ( node % bitsPerWord );
+            mode = mpolPreferred;
+        }
+        if( mask.empty( ) )
+            return cuplaNumaPlacementDefault;
+
+        long const result = ::syscall(
+            SYS_mbind,
+            ptr,
+            bytes,
+            mode,
+            mask.data( ),
+            mask.size( ) * bitsPerWord + 1u,
+            0u
+        );
+        if( result == 0 )
+            return placement;
+#else
+        (void) ptr;
+        (void) bytes;
+#endif
+        return cuplaNumaPlacementDefault;
+    }
+
+} // namespace detail
+} // namespace cupla
@@ -0,0 +1,323 @@
+/**
+ * Copyright 2016 Rene Widera
+ *
+ * This file is part of cupla.
+ *
+ * cupla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cupla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cupla.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cupla
+{
+namespace detail
+{
+
+    /** container which identifies its values by generation tagged handles
+     *
+     * A handle stores the slot index in the lower and the generation of the
+     * slot in the upper half of an integer. The generation is increased each
+     * time a slot is released, so a handle of a destroyed value never
+     * matches a value created later in the same slot.
+     *
+     * The slot 0 with generation 0 is reserved, the handle 0 is only valid
+     * after a value is inserted with insertReserved(). Values are stored in
+     * fixed size chunks of slots without an extra heap allocation and keep
+     * their address until they are erased.
+     *
+     * All methods are thread safe. find() is lock free and O(1), methods
+     * which insert or remove values are serialized by a mutex. A value must
+     * not be erased while it is used by another thread.
+     */
+    template< typename T_Value >
+    class SlotMap
+    {
+    public:
+        using Handle = std::uintptr_t;
+
+        SlotMap( ) :
+            m_chunks( new std::atomic< Chunk * >[ maxChunks ] ),
+            m_numSlots( 0u ),
+            m_size( 0u )
+        {
+            for( std::size_t i = 0u; i < maxChunks; ++i )
+                m_chunks[ i ].store( nullptr, std::memory_order_relaxed );
+            this->addSlot( );
+        }
+
+        SlotMap( SlotMap const & ) = delete;
+        SlotMap & operator=( SlotMap const & ) = delete;
+
+        ~SlotMap( )
+        {
+            this->clear( );
+            for( std::size_t i = 0u; i < maxChunks; ++i )
+                delete m_chunks[ i ].load( std::memory_order_relaxed );
+        }
+
+        /** construct a value in a free slot
+         *
+         * @return handle of the value, never 0
+         */
+        template< typename ... T_Args >
+        auto
+        insert( T_Args && ... args )
+        -> Handle
+        {
+            std::lock_guard< std::mutex > lock( m_mutex );
+
+            std::size_t index;
+            if( m_freeSlots.empty( ) )
+            {
+                index = this->addSlot( );
+                // generation 0 is only used by the reserved slot
+                this->slot( index ).generation = 1u;
+            }
+            else
+            {
+                index = m_freeSlots.back( );
+                m_freeSlots.pop_back( );
+            }
+            Slot & slot = this->slot( index );
+            Handle const handle = makeHandle( index, slot.generation );
+            slot.construct( handle, std::forward< T_Args >( args ) ... );
+            ++m_size;
+            return handle;
+        }
+
+        /** construct the value of the handle 0
+         *
+         * @return false if the reserved slot is already used
+         */
+        template< typename ... T_Args >
+        auto
+        insertReserved( T_Args && ... args )
+        -> bool
+        {
+            std::lock_guard< std::mutex > lock( m_mutex );
+
+            Slot & slot = this->slot( 0u );
+            if( slot.handle.load( std::memory_order_relaxed ) != freeHandle )
+                return false;
+            slot.construct( Handle( 0u ), std::forward< T_Args >( args ) ... );
+            ++m_size;
+            return true;
+        }
+
+        /** @return nullptr if the handle belongs to no value */
+        auto
+        find( Handle const handle ) const
+        -> T_Value *
+        {
+            std::size_t const index = handle & indexMask;
+            if( index >= m_numSlots.load( std::memory_order_acquire ) )
+                return nullptr;
+            Slot & slot = this->slot( index );
+            if( slot.handle.load( std::memory_order_acquire ) != handle )
+                return nullptr;
+            return &slot.value( );
+        }
+
+        /** destroy the value of a handle
+         *
+         * @return false if the handle belongs to no value
+         */
+        auto
+        erase( Handle const handle )
+        -> bool
+        {
+            std::lock_guard< std::mutex > lock( m_mutex );
+
+            if( this->find( handle ) == nullptr )
+                return false;
+            this->release( handle & indexMask );
+            --m_size;
+            return true;
+        }
+
+        //! destroy all values, handles of the values get invalid
+        void
+        clear( )
+        {
+            std::lock_guard< std::mutex > lock( m_mutex );
+
+            std::size_t const numSlots = m_numSlots.load( std::memory_order_relaxed );
+            for( std::size_t index = 0u; index < numSlots; ++index )
+                if( this->slot( index ).handle.load( std::memory_order_relaxed ) != freeHandle )
+                    this->release( index );
+            m_size = 0u;
+        }
+
+        /** call `func( handle, value )` for each value
+         *
+         * Values can not be inserted or removed while func is called.
+         */
+        template< typename T_Func >
+        void
+        forEach( T_Func && func )
+        {
+            std::lock_guard< std::mutex > lock( m_mutex );
+
+            std::size_t const numSlots = m_numSlots.load( std::memory_order_relaxed );
+            for( std::size_t index = 0u; index < numSlots; ++index )
+            {
+                Slot & slot = this->slot( index );
+                Handle const handle = slot.handle.load( std::memory_order_relaxed );
+                if( handle != freeHandle )
+                    func( handle, slot.value( ) );
+            }
+        }
+
+        auto
+        size( ) const
+        -> std::size_t
+        {
+            return m_size.load( );
+        }
+
+        auto
+        empty( ) const
+        -> bool
+        {
+            return this->size( ) == 0u;
+        }
+
+    private:
+
+        static constexpr unsigned indexBits = sizeof( Handle ) * 4u;
+        static constexpr Handle indexMask = ( Handle( 1u ) << indexBits ) - 1u;
+        static constexpr Handle generationMask = ~Handle( 0u ) >> indexBits;
+        //! never a valid handle because the index is out of range
+        static constexpr Handle freeHandle = ~Handle( 0u );
+
+        static constexpr std::size_t chunkSize = 256u;
+        static constexpr std::size_t maxChunks = 4096u;
+
+        struct Slot
+        {
+            typename std::aligned_storage<
+                sizeof( T_Value ),
+                alignof( T_Value )
+            >::type storage;
+            //! handle of the value or freeHandle, written last on insert
+            std::atomic< Handle > handle;
+            //! generation of the next value, only used with the mutex
+            Handle generation;
+
+            Slot( ) :
+                handle( freeHandle ),
+                generation( 0u )
+            { }
+
+            template< typename ... T_Args >
+            void
+            construct(
+                Handle const valueHandle,
+                T_Args && ... args
+            )
+            {
+                new ( &storage ) T_Value( std::forward< T_Args >( args ) ... );
+                handle.store( valueHandle, std::memory_order_release );
+            }
+
+            auto
+            value( )
+            -> T_Value &
+            {
+                return *reinterpret_cast< T_Value * >( &storage );
+            }
+        };
+
+        struct Chunk
+        {
+            Slot slots[ chunkSize ];
+        };
+
+        static auto
+        makeHandle(
+            std::size_t const index,
+            Handle const generation
+        )
+        -> Handle
+        {
+            return ( generation << indexBits ) | static_cast< Handle >( index );
+        }
+
+        auto
+        slot( std::size_t const index ) const
+        -> Slot &
+        {
+            Chunk * const chunk = m_chunks[ index / chunkSize ].load(
+                std::memory_order_acquire
+            );
+            return chunk->slots[ index % chunkSize ];
+        }
+
+        //! append a slot, must be called with the mutex
+        auto
+        addSlot( )
+        -> std::size_t
+        {
+            std::size_t const index = m_numSlots.load( std::memory_order_relaxed );
+            if( index == maxChunks * chunkSize )
+                throw std::length_error( "cupla::detail::SlotMap: no free slot" );
+            if( index % chunkSize == 0u )
+                m_chunks[ index / chunkSize ].store(
+                    new Chunk( ),
+                    std::memory_order_release
+                );
+            m_numSlots.store( index + 1u, std::memory_order_release );
+            return index;
+        }
+
+        //! must be called with the mutex
+        void
+        release( std::size_t const index )
+        {
+            Slot & slot = this->slot( index );
+            slot.handle.store( freeHandle, std::memory_order_release );
+            slot.value( ).~T_Value( );
+            // the reserved slot keeps generation 0 and is never reused
+            if( index == 0u )
+                return;
+            slot.generation = ( slot.generation + 1u ) & generationMask;
+            if( slot.generation == 0u )
+                slot.generation = 1u;
+            m_freeSlots.push_back( index );
+        }
+
+        //! chunks are never moved or deleted before the map is destroyed
+        std::unique_ptr< std::atomic< Chunk * >[] > m_chunks;
+        std::atomic< std::size_t > m_numSlots;
+        std::atomic< std::size_t > m_size;
+        std::vector< std::size_t > m_freeSlots;
+        std::mutex m_mutex;
+    };
+
+} // namespace detail
+} // namespace cupla
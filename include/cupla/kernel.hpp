@@ -28,6 +28,8 @@
 #include "cupla/datatypes/uint.hpp"
 #include "cupla/manager/Stream.hpp"
 #include "cupla/manager/Device.hpp"
+#include "cupla/manager/PointerRegistry.hpp"
+#include "cupla/detail/LastError.hpp"
 
 #include <utility>
 
@@ -110,9 +112,16 @@ void startKernel(
     uint3 const & gridSize,
     uint3 const & blockSize,
     uint3 const & elemPerThread,
-    T_Stream & stream,
+    T_Stream * const stream,
     T_Args && ... args
 ){
+  // the stream handle is unknown or was destroyed
+  if( stream == nullptr )
+  {
+    detail::lastError() = cuplaErrorInvalidResourceHandle;
+    return;
+  }
+
 
   auto dev( manager::Device<AccDev>::get().current() );
   ::alpaka::workdiv::WorkDivMembers<
@@ -124,7 +133,9 @@ void startKernel(
       static_cast<IdxVec3>(elemPerThread)
   );
   auto const exec(::alpaka::exec::create<Acc>(workDiv, kernel, args...));
-  ::alpaka::stream::enqueue(stream, exec);
+  // the kernel can write to any pristine allocation
+  ++manager::PointerRegistry::writeEpoch();
+  ::alpaka::stream::enqueue(*stream, exec);
 }
 
 } // namespace cupla
@@ -181,14 +192,13 @@ namespace traits
     const uint3 cuplaGridSize = dim3(gridSize);                                \
     const uint3 cuplaBlockSize = dim3(blockSize);                              \
     const uint3 cuplaElemPerThread = dim3(elemSize);                           \
-    auto& cuplaStream(                                                         \
+    auto * const cuplaStream =                                                 \
         cupla::manager::Stream<                                                \
             cupla::AccDev,                                                     \
             cupla::AccStream                                                   \
         >::get().stream(                                                       \
             cupla::KernelHelper::getStream( __VA_ARGS__ )                      \
-        )                                                                      \
-    );                                                                         \
+        );                                                                     \
     size_t const cuplaSharedMemSize = cupla::KernelHelper::getSharedMemSize(   \
         __VA_ARGS__                                                            \
     );                                                                         \
@@ -0,0 +1,187 @@
+/**
+ * Copyright 2016 Rene Widera
+ *
+ * This file is part of cupla.
+ *
+ * cupla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cupla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cupla.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#pragma once
+
+#include "cupla/types.hpp"
+#include "cupla_driver_types.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cupla
+{
+namespace manager
+{
+
+/** records allocations and releases of the memory managers
+ *
+ * The tracer is enabled with the environment variable `CUPLA_ALLOC_TRACE`
+ * which names the JSON file written at cuplaDeviceReset() and at process
+ * exit. Each of these dumps is written to an own file, the first to
+ * `CUPLA_ALLOC_TRACE`, the following with the suffix `.1`, `.2`, ... Events are kept in a ring buffer with `CUPLA_ALLOC_TRACE_SIZE`
+ * entries (default 65536), the oldest events are overwritten. The live
+ * bytes per caller tag at the peak of the live memory are always complete.
+ */
+class AllocationTracer
+{
+
+public:
+    struct Event
+    {
+        //! nanoseconds since the tracer was created
+        uint64_t time;
+        void const * ptr;
+        MemSizeType bytes;
+        cuplaStream_t stream;
+        char const * tag;
+        int device;
+        uint32_t dim;
+        cuplaMemoryType type;
+        bool isAlloc;
+    };
+
+    static AllocationTracer& get()
+    {
+        static AllocationTracer tracer;
+        return tracer;
+    }
+
+    ~AllocationTracer();
+
+    bool
+    isEnabled( ) const
+    {
+        return m_enabled;
+    }
+
+    /** set the tag of all following allocations of the calling thread
+     *
+     * The tag is copied, nullptr removes the tag.
+     */
+    void
+    setTag( char const * tag );
+
+    void
+    recordAlloc(
+        void const * ptr,
+        MemSizeType bytes,
+        uint32_t dim,
+        int device,
+        cuplaMemoryType type,
+        cuplaStream_t stream
+    );
+
+    void
+    recordFree(
+        void const * ptr,
+        cuplaStream_t stream
+    );
+
+    /** write the timeline and the peak breakdown as JSON
+     *
+     * The sites are ordered by their tag.
+     *
+     * @param fileName file to write, nullptr uses the next file name derived
+     *                 from `CUPLA_ALLOC_TRACE`
+     * @return false if the file can not be written
+     */
+    bool
+    dump( char const * fileName = nullptr );
+
+private:
+
+    struct Live
+    {
+        MemSizeType bytes;
+        char const * tag;
+        int device;
+        uint32_t dim;
+        cuplaMemoryType type;
+    };
+
+    struct Site
+    {
+        MemSizeType bytes;
+        std::size_t count;
+    };
+
+    //! orders interned tags by their text, the untagged site first
+    struct TagLess
+    {
+        bool
+        operator()(
+            char const * const lhs,
+            char const * const rhs
+        ) const
+        {
+            if( lhs == nullptr || rhs == nullptr )
+                return lhs == nullptr && rhs != nullptr;
+            return std::strcmp( lhs, rhs ) < 0;
+        }
+    };
+
+    using SiteMap = std::map< char const *, Site, TagLess >;
+
+    bool m_enabled;
+    std::string m_fileName;
+    //! number of dumps written to the default file name
+    std::size_t m_numDumps;
+    std::chrono::steady_clock::time_point m_start;
+    std::mutex m_mutex;
+
+    std::vector< Event > m_events;
+    //! number of recorded events, m_events is used as ring buffer
+    uint64_t m_numEvents;
+
+    std::set< std::string > m_tags;
+    std::unordered_map< void const *, Live > m_live;
+    SiteMap m_liveSites;
+    MemSizeType m_liveBytes;
+
+    MemSizeType m_peakBytes;
+    uint64_t m_peakTime;
+    SiteMap m_peakSites;
+    /** the live sites are the sites of the peak, they are copied to
+     *  m_peakSites before the next release
+     */
+    bool m_isPeakLive;
+
+    AllocationTracer();
+
+    uint64_t
+    now( ) const;
+
+    void
+    push( Event const & event );
+};
+
+} //namespace manager
+} //namespace cupla
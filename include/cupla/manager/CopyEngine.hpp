@@ -0,0 +1,246 @@
+/**
+ * Copyright 2016 Rene Widera
+ *
+ * This file is part of cupla.
+ *
+ * cupla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cupla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cupla.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+namespace cupla
+{
+namespace manager
+{
+
+/** multi threaded memory copies and fills for CPU accelerators
+ *
+ * Large copies are split into page aligned chunks which are copied by a pool
+ * of threads, the calling thread takes part in the copy. Copies larger than
+ * the non temporal threshold bypass the cache with streaming stores.
+ *
+ * The default configuration can be changed with the environment variables
+ *   - `CUPLA_MEMCPY_THREADS` number of threads used for one copy, the
+ *     default is the number of cores not used by the stream worker pool
+ *     (at least 1, at most 8)
+ *   - `CUPLA_MEMCPY_CHUNK_SIZE` minimal number of bytes per chunk
+ *   - `CUPLA_MEMCPY_NT_THRESHOLD` minimal number of bytes of a copy to use
+ *     non temporal stores
+ *   - `CUPLA_MEMCPY_BIND` if set to 1 the threads of the pool are bound
+ *     to cores spread over all available cores (and NUMA nodes)
+ *
+ * The threads are started with the first copy which is split into more than
+ * one chunk. Copies are executed by the stream workers, the stream worker
+ * issuing a copy is the first copy thread. With the default configuration the
+ * stream workers and the copy threads together do not oversubscribe the cores.
+ */
+class CopyEngine
+{
+
+public:
+    static CopyEngine& get()
+    {
+        static CopyEngine engine;
+        return engine;
+    }
+
+    ~CopyEngine();
+
+    /** copy contiguous memory
+     *
+     * blocks until the copy is finished
+     */
+    void
+    copy(
+        void * dst,
+        void const * src,
+        std::size_t bytes
+    );
+
+    /** copy pitched memory
+     *
+     * Dimensions without gaps are coalesced, a contiguous copy is executed
+     * as one dimensional copy and else the rows are distributed over all
+     * threads. Blocks until the copy is finished.
+     *
+     * @param dstPitch bytes of a row in the destination
+     * @param dstSlicePitch bytes of a slice in the destination
+     * @param width bytes to copy per row
+     */
+    void
+    copy3D(
+        void * dst,
+        std::size_t dstPitch,
+        std::size_t dstSlicePitch,
+        void const * src,
+        std::size_t srcPitch,
+        std::size_t srcSlicePitch,
+        std::size_t width,
+        std::size_t height,
+        std::size_t depth
+    );
+
+    /** copy a list of independent contiguous memory regions
+     *
+     * Small copies are grouped and the groups are distributed over all
+     * threads. Blocks until all copies are finished.
+     */
+    void
+    copyBatch(
+        void * const * dsts,
+        void const * const * srcs,
+        std::size_t const * sizes,
+        std::size_t count
+    );
+
+    /** fill contiguous memory with an element value
+     *
+     * blocks until the memory is set
+     *
+     * @param value element value, only the lowest `elemSize` bytes are used
+     * @param elemSize bytes of an element: 1, 2, 4 or 8
+     * @param bytes number of bytes to set, should be a multiple of elemSize
+     */
+    void
+    set(
+        void * dst,
+        uint64_t value,
+        std::size_t elemSize,
+        std::size_t bytes
+    );
+
+    /** fill pitched memory with an element value
+     *
+     * Only `width` bytes of each row are written, the padding between the
+     * rows and slices is not touched. Each row starts with a new element.
+     * Blocks until the memory is set.
+     *
+     * @param pitch bytes of a row
+     * @param slicePitch bytes of a slice
+     * @param value element value, only the lowest `elemSize` bytes are used
+     * @param elemSize bytes of an element: 1, 2, 4 or 8
+     * @param width bytes to set per row
+     */
+    void
+    set3D(
+        void * dst,
+        std::size_t pitch,
+        std::size_t slicePitch,
+        uint64_t value,
+        std::size_t elemSize,
+        std::size_t width,
+        std::size_t height,
+        std::size_t depth
+    );
+
+    /** call `func( i )` for each i in [0;size) with all threads of the pool
+     *
+     * blocks until all calls are finished
+     */
+    void
+    parallelFor(
+        std::size_t size,
+        std::function< void( std::size_t ) > const & func
+    );
+
+    /** set the number of threads used for one copy (including the caller)
+     *
+     * must not be called while a copy is executed
+     */
+    void
+    setNumThreads( std::size_t numThreads );
+
+    std::size_t
+    getNumThreads( ) const
+    {
+        return m_numThreads;
+    }
+
+    /** set the bytes copied per task
+     *
+     * The size is rounded up to a multiple of the page size, 0 is ignored.
+     */
+    void
+    setChunkSize( std::size_t chunkSize );
+
+    void
+    setNonTemporalThreshold( std::size_t bytes );
+
+private:
+
+    struct Job;
+
+    std::vector< std::thread > m_workers;
+    std::size_t m_numThreads;
+    std::size_t m_numWorkers;
+    std::atomic< bool > m_started;
+    std::deque< std::shared_ptr< Job > > m_jobs;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stop;
+    bool m_bindThreads;
+
+    std::size_t m_chunkSize;
+    std::size_t m_nonTemporalThreshold;
+
+    CopyEngine();
+
+    void
+    work( std::size_t workerIdx );
+
+    /** start `getNumThreads() - 1` workers if they are not running */
+    void
+    startWorkers( );
+
+    void
+    stopWorkers( );
+
+    /** copy a chunk with the calling thread */
+    void
+    copyChunk(
+        uint8_t * dst,
+        uint8_t const * src,
+        std::size_t bytes,
+        bool nonTemporal
+    ) const;
+
+    /** fill a chunk with the calling thread
+     *
+     * @param pattern 8 byte pattern starting at dst
+     */
+    void
+    setChunk(
+        uint8_t * dst,
+        uint64_t pattern,
+        std::size_t bytes,
+        bool nonTemporal
+    ) const;
+};
+
+} //namespace manager
+} //namespace cupla
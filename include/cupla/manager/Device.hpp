@@ -23,14 +23,21 @@
 #pragma once
 
 #include "cupla/types.hpp"
+#include <atomic>
 #include <map>
 #include <memory>
+#include <mutex>
 
 namespace cupla
 {
 namespace manager
 {
 
+    /** manager of the devices
+     *
+     * A created device is looked up lock free, creating and resetting a
+     * device is serialized. The current device is selected per host thread.
+     */
     template<
         typename T_DeviceType
     >
@@ -45,8 +52,12 @@ namespace manager
             >
         >;
 
+        //! owner of the devices, only used with m_mutex
         DeviceMap m_map;
-        int m_currentDevice;
+        //! lock free view on the devices of m_map indexed by the device id
+        std::unique_ptr< std::atomic< DeviceType* >[] > m_devices;
+        int m_numDevices;
+        std::mutex m_mutex;
 
         static Device &
         get()
@@ -61,7 +72,17 @@ namespace manager
         )
         -> DeviceType &
         {
-            m_currentDevice = idx;
+            currentDevice( ) = idx;
+            if( idx >= 0 && idx < m_numDevices )
+            {
+                DeviceType* dev = m_devices[ idx ].load(
+                    std::memory_order_acquire
+                );
+                if( dev != nullptr )
+                    return *dev;
+            }
+
+            std::lock_guard< std::mutex > lock( m_mutex );
             auto iter = m_map.find( idx );
             if( iter != m_map.end() )
             {
@@ -84,34 +105,43 @@ namespace manager
                         )
                     )
                 );
+                DeviceType* devPtr = dev.get();
                 m_map.insert(
                     std::make_pair( idx, std::move( dev ) )
                 );
-                return *m_map[ idx ];
+                if( idx >= 0 && idx < m_numDevices )
+                    m_devices[ idx ].store( devPtr, std::memory_order_release );
+                return *devPtr;
             }
         }
 
         /**! reset the current device
          *
          * streams, memory and events on the current device must be
-         * deleted at first by the user
+         * deleted at first by the user and the device must not be used
+         * by other threads
          *
          * @return true in success case else false
          */
         bool reset()
         {
             ::alpaka::dev::reset( this->current( ) );
-            auto iter = m_map.find( this->id( ) );
+
+            std::lock_guard< std::mutex > lock( m_mutex );
+            const int idx = this->id( );
+            auto iter = m_map.find( idx );
 
             if( iter == m_map.end() )
             {
-                std::cerr << "device " << this->id( ) <<
+                std::cerr << "device " << idx <<
                     " can not destroyed (was never created) " <<
                     std::endl;
                 return false;
             }
             else
             {
+                if( idx >= 0 && idx < m_numDevices )
+                    m_devices[ idx ].store( nullptr, std::memory_order_release );
                 m_map.erase( iter );
                 return true;
             }
@@ -121,7 +151,7 @@ namespace manager
         id()
         -> int
         {
-            return m_currentDevice;
+            return currentDevice( );
         }
 
         auto
@@ -139,9 +169,21 @@ namespace manager
         }
 
     protected:
-        Device() : m_currentDevice( 0 )
+        Device() :
+            m_numDevices( this->count( ) )
         {
+            m_devices.reset( new std::atomic< DeviceType* >[ m_numDevices ] );
+            for( int i = 0; i < m_numDevices; ++i )
+                m_devices[ i ].store( nullptr, std::memory_order_relaxed );
+        }
 
+        //! id of the current device of the calling thread
+        static auto
+        currentDevice()
+        -> int &
+        {
+            static thread_local int deviceId = 0;
+            return deviceId;
         }
 
     };
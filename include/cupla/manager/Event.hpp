@@ -25,9 +25,9 @@
 #include "cupla/types.hpp"
 #include "cupla/manager/Device.hpp"
 #include "cupla_driver_types.hpp"
+#include "cupla/detail/SlotMap.hpp"
 
 #include <vector>
-#include <map>
 #include <memory>
 #include <utility>
 #include <chrono>
@@ -115,12 +115,8 @@ namespace detail
             StreamType
         >;
 
-        using EventMap = std::map<
-            cuplaEvent_t,
-            std::unique_ptr<
-                EventType
-            >
-        >;
+        //! the handle of an event is the slot map handle
+        using EventMap = cupla::detail::SlotMap< EventType >;
 
         using MapVector = std::vector< EventMap >;
 
@@ -138,42 +134,33 @@ namespace detail
         create( uint32_t flags )
         -> cuplaEvent_t
         {
-
             auto& device = Device< DeviceType >::get();
 
-            std::unique_ptr<
-                EventType
-            > eventPtr(
-                new EventType(
-                    flags
-                )
-            );
-            cuplaEvent_t eventId = reinterpret_cast< cuplaEvent_t >(
-                m_mapVector[ device.id() ].size()
+            return reinterpret_cast< cuplaEvent_t >(
+                m_mapVector[ device.id() ].insert( flags )
             );
-            m_mapVector[ device.id() ].insert(
-                std::make_pair( eventId, std::move( eventPtr ) )
-            );
-            return eventId;
         }
 
+        /** get an event
+         *
+         * @return nullptr if the event does not exist (anymore)
+         */
         auto
         event( cuplaEvent_t eventId = 0 )
-        -> EventType &
+        -> EventType *
         {
             auto& device = Device< DeviceType >::get();
             const auto deviceId = device.id();
-            auto iter = m_mapVector[ deviceId ].find(
-                eventId
+            EventType * const result = m_mapVector[ deviceId ].find(
+                reinterpret_cast< typename EventMap::Handle >( eventId )
             );
 
-            if( iter == m_mapVector[ device.id( ) ].end() )
+            if( result == nullptr )
             {
                 std::cerr << "event " << eventId <<
                     " not exists on device "<< deviceId << std::endl;
             }
-            // @todo: check if stream was created
-            return *(iter->second);
+            return result;
         }
 
         auto
@@ -183,23 +170,19 @@ namespace detail
             auto& device = Device< DeviceType >::get();
             const auto deviceId = device.id();
 
-            auto iter = m_mapVector[ deviceId ].find(
-                eventId
-            );
-
-            if( iter == m_mapVector[ deviceId ].end() )
+            if(
+                !m_mapVector[ deviceId ].erase(
+                    reinterpret_cast< typename EventMap::Handle >( eventId )
+                )
+            )
             {
-                std::cerr << "stream " << eventId <<
+                std::cerr << "event " << eventId <<
                     " can not destroyed (was never created) on device " <<
                     deviceId <<
                     std::endl;
                 return false;
             }
-            else
-            {
-                m_mapVector[ deviceId ].erase( iter );
-                return true;
-            }
+            return true;
         }
 
         /** delete all events on the current device
@@ -24,25 +24,362 @@
 
 #include "cupla/types.hpp"
 #include "cupla/manager/Device.hpp"
+#include "cupla/manager/PointerRegistry.hpp"
+#include "cupla/manager/AllocationTracer.hpp"
+#include "cupla/detail/HugePages.hpp"
+#include "cupla/detail/Numa.hpp"
+#include "cupla_driver_types.hpp"
 
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <memory>
 #include <utility>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <functional>
+#include <type_traits>
+#include <atomic>
+#include <mutex>
 
 namespace cupla
 {
 namespace manager
 {
 
+namespace detail
+{
+
+    /** number of bytes held by the memory caches of all devices of a type
+     *
+     * The limit and the statistics are shared between the memory managers of
+     * all dimensions which use the same device and memory type. The mutex of
+     * a device serializes these memory managers and guards the counters of
+     * the device.
+     */
     template<
         typename T_DeviceType,
-        typename T_Dim
+        cuplaMemoryType T_memoryType
+    >
+    struct MemoryCacheBudget
+    {
+        using DeviceType = T_DeviceType;
+
+        std::vector< MemSizeType > m_cachedBytes;
+        //! bytes of released blocks which are deleted after their work is finished
+        std::vector< MemSizeType > m_pendingBytes;
+        std::atomic< MemSizeType > m_limit;
+        //! maximal number of live and cached bytes per device
+        std::vector< MemSizeType > m_capacity;
+        /** statistics per device, cachedBytes, cacheLimit and capacity are
+         *  not used
+         */
+        std::vector< cuplaMemPoolStats > m_stats;
+        //! recursive because a manager trims its cache while it is locked
+        mutable std::vector< std::recursive_mutex > m_mutexes;
+
+        static auto
+        get()
+        -> MemoryCacheBudget &
+        {
+            static MemoryCacheBudget budget;
+            return budget;
+        }
+
+        auto
+        mutex( int const deviceId ) const
+        -> std::recursive_mutex &
+        {
+            return m_mutexes[ deviceId ];
+        }
+
+        void
+        setCapacity(
+            int const deviceId,
+            MemSizeType const bytes
+        )
+        {
+            std::lock_guard< std::recursive_mutex > lock( this->mutex( deviceId ) );
+            m_capacity[ deviceId ] = bytes;
+        }
+
+        /** check if a block with the given size fits into the cache */
+        auto
+        fits(
+            int const deviceId,
+            MemSizeType const bytes
+        ) const
+        -> bool
+        {
+            return bytes <= m_limit &&
+                m_cachedBytes[ deviceId ] <= m_limit - bytes;
+        }
+
+        /** check if a new block with the given size can be allocated
+         *  without exceeding the capacity of the device
+         */
+        auto
+        hasCapacity(
+            int const deviceId,
+            MemSizeType const bytes
+        ) const
+        -> bool
+        {
+            MemSizeType const used =
+                m_stats[ deviceId ].liveBytes +
+                m_cachedBytes[ deviceId ] +
+                m_pendingBytes[ deviceId ];
+            return used <= m_capacity[ deviceId ] &&
+                bytes <= m_capacity[ deviceId ] - used;
+        }
+
+        /** account a block handed out by a memory manager
+         *
+         * @param fromCache true if the block was reused from the cache
+         */
+        void
+        addLive(
+            int const deviceId,
+            MemSizeType const bytes,
+            bool const fromCache
+        )
+        {
+            auto& stats = m_stats[ deviceId ];
+            stats.liveBytes += bytes;
+            ++stats.numAllocations;
+            if( fromCache )
+                ++stats.numCacheHits;
+            if( stats.liveBytes > stats.peakLiveBytes )
+                stats.peakLiveBytes = stats.liveBytes;
+            if( stats.liveBytes + m_cachedBytes[ deviceId ] > stats.highWaterBytes )
+                stats.highWaterBytes = stats.liveBytes + m_cachedBytes[ deviceId ];
+        }
+
+        //! account a block released by a memory manager
+        void
+        removeLive(
+            int const deviceId,
+            MemSizeType const bytes
+        )
+        {
+            m_stats[ deviceId ].liveBytes -= bytes;
+            ++m_stats[ deviceId ].numFrees;
+        }
+
+        auto
+        stats( int const deviceId ) const
+        -> cuplaMemPoolStats
+        {
+            std::lock_guard< std::recursive_mutex > lock( this->mutex( deviceId ) );
+            cuplaMemPoolStats result = m_stats[ deviceId ];
+            result.cachedBytes = m_cachedBytes[ deviceId ];
+            result.cacheLimit = m_limit;
+            result.capacity = m_capacity[ deviceId ];
+            return result;
+        }
+
+    protected:
+        MemoryCacheBudget() :
+            m_cachedBytes( Device< DeviceType >::get().count(), 0 ),
+            m_pendingBytes( Device< DeviceType >::get().count(), 0 ),
+            m_limit( std::numeric_limits< MemSizeType >::max() ),
+            m_capacity(
+                Device< DeviceType >::get().count(),
+                std::numeric_limits< MemSizeType >::max()
+            ),
+            m_stats( Device< DeviceType >::get().count(), cuplaMemPoolStats() ),
+            m_mutexes( Device< DeviceType >::get().count() )
+        {
+            /* CUPLA_MEM_CAPACITY (CUPLA_HOST_MEM_CAPACITY for host memory)
+             * is the number of bytes which can be allocated per device
+             */
+            char const * const capacityEnv = std::getenv(
+                T_memoryType == cuplaMemoryTypeHost ?
+                    "CUPLA_HOST_MEM_CAPACITY" :
+                    "CUPLA_MEM_CAPACITY"
+            );
+            if( capacityEnv != nullptr )
+                for( auto& capacity : m_capacity )
+                    capacity = static_cast< MemSizeType >(
+                        std::strtoull( capacityEnv, nullptr, 10 )
+                    );
+
+            /* CUPLA_MEM_CACHE_LIMIT (CUPLA_HOST_MEM_CACHE_LIMIT for host
+             * memory) is the number of bytes which can be cached per device,
+             * 0 disables the cache
+             */
+            char const * const limitEnv = std::getenv(
+                T_memoryType == cuplaMemoryTypeHost ?
+                    "CUPLA_HOST_MEM_CACHE_LIMIT" :
+                    "CUPLA_MEM_CACHE_LIMIT"
+            );
+            if( limitEnv != nullptr )
+                m_limit = static_cast< MemSizeType >(
+                    std::strtoull( limitEnv, nullptr, 10 )
+                );
+        }
+    };
+
+    /** selects the allocations which are backed by huge pages
+     *
+     * CUPLA_HUGEPAGE_THRESHOLD is the minimal size in bytes of an allocation
+     * which is backed by huge pages. Without the variable huge pages are only
+     * used if requested with cuplaMallocHugePages.
+     */
+    struct HugePagePolicy
+    {
+        std::atomic< MemSizeType > m_threshold;
+
+        static auto
+        get()
+        -> HugePagePolicy &
+        {
+            static HugePagePolicy policy;
+            return policy;
+        }
+
+        auto
+        use(
+            MemSizeType const bytes,
+            unsigned int const flags
+        ) const
+        -> bool
+        {
+            if( flags & cuplaMallocNoHugePages )
+                return false;
+            return ( flags & cuplaMallocHugePages ) || bytes >= m_threshold;
+        }
+
+    protected:
+        HugePagePolicy() :
+            m_threshold( std::numeric_limits< MemSizeType >::max() )
+        {
+            char const * const thresholdEnv = std::getenv(
+                "CUPLA_HUGEPAGE_THRESHOLD"
+            );
+            if( thresholdEnv != nullptr )
+                m_threshold = static_cast< MemSizeType >(
+                    std::strtoull( thresholdEnv, nullptr, 10 )
+                );
+        }
+    };
+
+    /** selects the NUMA placement of allocations
+     *
+     * CUPLA_NUMA_PLACEMENT (`interleave`, `local` or `firsttouch`) sets the
+     * placement of allocations without a NUMA flag.
+     */
+    struct NumaPolicy
+    {
+        std::atomic< cuplaNumaPlacement > m_placement;
+
+        static auto
+        get()
+        -> NumaPolicy &
+        {
+            static NumaPolicy policy;
+            return policy;
+        }
+
+        auto
+        placement( unsigned int const flags ) const
+        -> cuplaNumaPlacement
+        {
+            if( flags & cuplaMallocNumaInterleave )
+                return cuplaNumaPlacementInterleave;
+            if( flags & cuplaMallocNumaLocal )
+                return cuplaNumaPlacementLocal;
+            if( flags & cuplaMallocNumaFirstTouch )
+                return cuplaNumaPlacementFirstTouch;
+            return m_placement;
+        }
+
+    protected:
+        NumaPolicy() :
+            m_placement( cuplaNumaPlacementDefault )
+        {
+            char const * const placementEnv = std::getenv(
+                "CUPLA_NUMA_PLACEMENT"
+            );
+            if( placementEnv == nullptr )
+                return;
+            if( std::strcmp( placementEnv, "interleave" ) == 0 )
+                m_placement = cuplaNumaPlacementInterleave;
+            else if( std::strcmp( placementEnv, "local" ) == 0 )
+                m_placement = cuplaNumaPlacementLocal;
+            else if( std::strcmp( placementEnv, "firsttouch" ) == 0 )
+                m_placement = cuplaNumaPlacementFirstTouch;
+        }
+    };
+
+    /** touch each page of untouched memory to place it on a NUMA node
+     *
+     * With AccCpuOmp2Blocks the pages are distributed with the static
+     * OpenMP schedule of the kernel blocks, so that each page is placed on
+     * the node of the thread which works on it later. The threads of the
+     * other CPU accelerators are not pinned, the pages are touched by the
+     * calling thread.
+     */
+    inline void
+    firstTouch(
+        uint8_t * const ptr,
+        std::size_t const bytes
+    )
+    {
+        constexpr std::size_t pageSize = 4096u;
+        auto const numPages = static_cast< long long >(
+            ( bytes + pageSize - 1u ) / pageSize
+        );
+#if defined(_OPENMP) && defined(ALPAKA_ACC_CPU_B_OMP2_T_SEQ_ENABLED)
+        #pragma omp parallel for schedule(static)
+#endif
+        for( long long page = 0; page < numPages; ++page )
+            ptr[ page * pageSize ] = 0u;
+    }
+
+    /** round a one dimensional allocation up to its size class
+     *
+     * Allocations up to 1 MiB are rounded to the next power of two (at least
+     * 256 byte), larger allocations to the next multiple of 1 MiB.
+     */
+    inline auto
+    sizeClass( MemSizeType const bytes )
+    -> MemSizeType
+    {
+        constexpr MemSizeType minClass = 256u;
+        constexpr MemSizeType maxPow2Class = 1024u * 1024u;
+
+        if( bytes > maxPow2Class )
+            return ( bytes + maxPow2Class - 1u ) / maxPow2Class * maxPow2Class;
+
+        MemSizeType sizeClass = minClass;
+        while( sizeClass < bytes )
+            sizeClass *= 2u;
+        return sizeClass;
+    }
+
+} // namespace detail
+
+    /** memory manager
+     *
+     * All methods can be called concurrently, the managers of a device and
+     * memory type are serialized by the mutex of their cache budget.
+     *
+     * @tparam T_memoryType memory type which is stored in the pointer
+     *                      registry, separates host and device memory if
+     *                      both use the same device type
+     */
+    template<
+        typename T_DeviceType,
+        typename T_Dim,
+        cuplaMemoryType T_memoryType = cuplaMemoryTypeDevice
     >
     struct Memory
     {
         using DeviceType = T_DeviceType;
         static constexpr uint32_t dim = T_Dim::value;
+        static constexpr cuplaMemoryType memoryType = T_memoryType;
 
         using BufType = ::alpaka::mem::buf::Buf<
             DeviceType,
@@ -51,16 +388,127 @@ namespace manager
             MemSizeType
         >;
 
-        using MemoryMap = std::map<
+        using CacheBudget = detail::MemoryCacheBudget<
+            DeviceType,
+            memoryType
+        >;
+
+#if defined(ALPAKA_ACC_GPU_CUDA_ENABLED)
+        //! pinning and mapping host memory for CUDA requires alpaka buffers
+        static constexpr bool hugePagesSupported = false;
+#else
+        static constexpr bool hugePagesSupported =
+            dim == 1u &&
+            std::is_same< DeviceType, ::alpaka::dev::DevCpu >::value;
+#endif
+
+        /** memory together with the extent used to allocate it
+         *
+         * One dimensional blocks are allocated with their size class, the
+         * registry, the tracer and the live bytes use the requested size.
+         *
+         * The memory is owned either by an alpaka buffer or by a mapping
+         * created by cupla, e.g. for huge pages or a NUMA placement.
+         */
+        struct Block
+        {
+            MemVec< dim > extent;
+            MemSizeType bytes;
+            //! bytes requested by the application, at most `bytes`
+            MemSizeType requestedBytes;
+            std::unique_ptr< BufType > buf;
+            std::shared_ptr< uint8_t > mapping;
+            cuplaHugePageType hugePages;
+            cuplaNumaPlacement numaPlacement;
+            //! memory is page locked for a CUDA device
+            bool pinned;
+            //! memory is owned by the application, see registerMemory()
+            bool registered;
+            /** test if all work which can use the block is finished
+             *
+             * empty if the block can be reused immediately
+             */
+            std::function< bool() > isReady;
+
+            Block( MemVec< dim > const & allocExtent ) :
+                extent( allocExtent ),
+                bytes( 0u ),
+                requestedBytes( 0u ),
+                hugePages( cuplaHugePageNone ),
+                numaPlacement( cuplaNumaPlacementDefault ),
+                pinned( false ),
+                registered( false )
+            { }
+
+            auto
+            ptr() const
+            -> uint8_t *
+            {
+                if( buf )
+                    return ::alpaka::mem::view::getPtrNative( *buf );
+                return mapping.get();
+            }
+
+            //! pitch of a row in bytes
+            auto
+            pitch() const
+            -> MemSizeType
+            {
+                if( buf )
+                    return ::alpaka::mem::view::getPitchBytes< dim - 1u >( *buf );
+                return bytes;
+            }
+
+            auto
+            ready()
+            -> bool
+            {
+                if( isReady && !isReady() )
+                    return false;
+                isReady = nullptr;
+                return true;
+            }
+        };
+
+        /** live blocks, hashed for a constant lookup on release
+         *
+         * Blocks keep their address until they are released.
+         */
+        using MemoryMap = std::unordered_map<
             uint8_t*,
-            std::unique_ptr<
-                BufType
-            >
+            Block
+        >;
+
+        /** freed blocks, the key is the size class (1D) or the number of
+         *  elements of the extent (2D and 3D)
+         */
+        using CacheMap = std::multimap<
+            MemSizeType,
+            Block
+        >;
+
+        /** blocks released stream ordered, reusable in their stream without
+         *  waiting
+         */
+        using StreamCacheMap = std::map<
+            cuplaStream_t,
+            CacheMap
         >;
 
+        /** released blocks which do not fit into the cache but can still be
+         *  used by queued work, deleted by releasePending()
+         */
+        using PendingList = std::vector< Block >;
+
         using MapVector = std::vector< MemoryMap >;
+        using CacheVector = std::vector< CacheMap >;
+        using StreamCacheVector = std::vector< StreamCacheMap >;
+        using PendingVector = std::vector< PendingList >;
 
         MapVector m_mapVector;
+        CacheVector m_cacheVector;
+        StreamCacheVector m_streamCacheVector;
+        PendingVector m_pendingVector;
 
         static auto
         get()
@@ -71,56 +519,366 @@ namespace manager
         }
 
 
+        /** allocate memory
+         *
+         * @param flags allocation flags, e.g. cuplaMallocHugePages, stored in
+         *              the pointer registry
+         * @return nullptr if the capacity of the device is exceeded
+         */
         auto
         alloc(
-            MemVec< dim > const & extent
+            MemVec< dim > const & extent,
+            unsigned int const flags = 0u
         )
-        -> BufType &
+        -> Block *
         {
+            auto& device = Device< DeviceType >::get();
+            const auto deviceId = device.id();
+            std::lock_guard< std::recursive_mutex > lock(
+                CacheBudget::get().mutex( deviceId )
+            );
+
+            this->releasePending( deviceId );
 
+            Block block( cacheExtent( extent ) );
+
+            bool found = false;
+            // zero filled memory is never taken from the cache
+            if( !( flags & cuplaMallocZeroInitialized ) )
+                found = this->takeFromCache(
+                    m_cacheVector[ deviceId ],
+                    deviceId,
+                    block,
+                    flags
+                );
+            for(
+                auto iter = m_streamCacheVector[ deviceId ].begin();
+                !found && iter != m_streamCacheVector[ deviceId ].end();
+                ++iter
+            )
+                found = this->takeFromCache(
+                    iter->second,
+                    deviceId,
+                    block,
+                    flags
+                );
+
+            return this->insert( deviceId, std::move( block ), extent, flags );
+        }
+
+        /** allocate memory stream ordered
+         *
+         * Memory released with freeAsync() to the same stream is reused
+         * without waiting for the stream.
+         *
+         * @return nullptr if the capacity of the device is exceeded
+         */
+        auto
+        allocAsync(
+            MemVec< dim > const & extent,
+            cuplaStream_t const streamId,
+            unsigned int const flags = 0u
+        )
+        -> Block *
+        {
             auto& device = Device< DeviceType >::get();
+            const auto deviceId = device.id();
+            std::lock_guard< std::recursive_mutex > lock(
+                CacheBudget::get().mutex( deviceId )
+            );
+            auto& streamCaches = m_streamCacheVector[ deviceId ];
 
-            std::unique_ptr<
-                BufType
-            > bufPtr(
-                new BufType(
-                    ::alpaka::mem::buf::alloc<uint8_t, MemSizeType>(
-                     device.current(),
-                     extent
-                    )
-                )
+            this->releasePending( deviceId );
+
+            Block block( cacheExtent( extent ) );
+
+            bool found = false;
+            auto streamCache = streamCaches.find( streamId );
+            if( streamCache != streamCaches.end() )
+                found = this->takeFromCache(
+                    streamCache->second,
+                    deviceId,
+                    block,
+                    flags,
+                    false
+                );
+            if( !found )
+                found = this->takeFromCache(
+                    m_cacheVector[ deviceId ],
+                    deviceId,
+                    block,
+                    flags
+                );
+            for(
+                auto iter = streamCaches.begin();
+                !found && iter != streamCaches.end();
+                ++iter
+            )
+                found = this->takeFromCache(
+                    iter->second,
+                    deviceId,
+                    block,
+                    flags
+                );
+
+            return this->insert(
+                deviceId,
+                std::move( block ),
+                extent,
+                flags,
+                streamId
             );
+        }
 
+        /** release memory
+         *
+         * The memory is kept in the cache of the current device if the
+         * cache limit is not reached, else it is released. Memory which can
+         * still be used by queued work is released after `isReady` returns
+         * true by a later alloc or trim.
+         *
+         * @param isReady test if all work which can use the memory is
+         *                finished, empty if the memory is unused
+         */
+        auto
+        free(
+            void * ptr,
+            std::function< bool() > const & isReady = std::function< bool() >( )
+        )
+        -> bool
+        {
+            auto& device = Device< DeviceType >::get();
+            const auto deviceId = device.id();
+            std::lock_guard< std::recursive_mutex > lock(
+                CacheBudget::get().mutex( deviceId )
+            );
 
-            uint8_t *nativePtr = ::alpaka::mem::view::getPtrNative(*bufPtr);
-            m_mapVector[ device.id() ].insert(
-                std::make_pair( nativePtr, std::move( bufPtr ) )
+            auto iter = m_mapVector[ deviceId ].find(
+                static_cast< uint8_t * >( ptr )
             );
-            return *m_mapVector[ device.id() ][ nativePtr ];
+
+            if(
+                iter == m_mapVector[ deviceId ].end() ||
+                iter->second.registered
+            )
+            {
+                return false;
+            }
+            else
+            {
+                PointerRegistry::get().erase( ptr );
+                AllocationTracer::get().recordFree( ptr, 0 );
+
+                auto& budget = CacheBudget::get();
+                Block& block = iter->second;
+                budget.removeLive( deviceId, block.requestedBytes );
+                block.isReady = isReady;
+                if( budget.fits( deviceId, block.bytes ) )
+                {
+                    budget.m_cachedBytes[ deviceId ] += block.bytes;
+                    m_cacheVector[ deviceId ].insert(
+                        std::make_pair( cacheKey( block.extent ), std::move( block ) )
+                    );
+                }
+                else if( !block.ready() )
+                    this->deferRelease( deviceId, std::move( block ) );
+                m_mapVector[ deviceId ].erase( iter );
+
+                if( budget.m_cachedBytes[ deviceId ] > budget.m_limit )
+                    this->trim( budget.m_limit );
+                return true;
+            }
         }
 
+        /** release memory stream ordered
+         *
+         * The memory can be reused by work in the stream `streamId` without
+         * waiting, other streams can reuse it after `isReady` returns true.
+         *
+         * @param isReady test if all work enqueued in the stream before the
+         *                release is finished
+         */
         auto
-        free( void * ptr)
+        freeAsync(
+            void * ptr,
+            cuplaStream_t const streamId,
+            std::function< bool() > const & isReady
+        )
         -> bool
         {
             auto& device = Device< DeviceType >::get();
             const auto deviceId = device.id();
+            std::lock_guard< std::recursive_mutex > lock(
+                CacheBudget::get().mutex( deviceId )
+            );
 
             auto iter = m_mapVector[ deviceId ].find(
                 static_cast< uint8_t * >( ptr )
             );
 
-            if( iter == m_mapVector[ deviceId ].end() )
+            if(
+                iter == m_mapVector[ deviceId ].end() ||
+                iter->second.registered
+            )
             {
                 return false;
             }
             else
             {
+                PointerRegistry::get().erase( ptr );
+                AllocationTracer::get().recordFree( ptr, streamId );
+
+                auto& budget = CacheBudget::get();
+                Block& block = iter->second;
+                budget.removeLive( deviceId, block.requestedBytes );
+                block.isReady = isReady;
+                if( budget.fits( deviceId, block.bytes ) )
+                {
+                    budget.m_cachedBytes[ deviceId ] += block.bytes;
+                    m_streamCacheVector[ deviceId ][ streamId ].insert(
+                        std::make_pair( cacheKey( block.extent ), std::move( block ) )
+                    );
+                }
+                // the block can not be deleted before the stream has finished
+                else if( !block.ready() )
+                    this->deferRelease( deviceId, std::move( block ) );
                 m_mapVector[ deviceId ].erase( iter );
+
+                if( budget.m_cachedBytes[ deviceId ] > budget.m_limit )
+                    this->trim( budget.m_limit );
                 return true;
             }
         }
 
+        /** register memory which is owned by the application
+         *
+         * The memory is handled like memory allocated by the manager but is
+         * never cached or released.
+         *
+         * @return nullptr if the memory overlaps with known memory
+         */
+        auto
+        registerMemory(
+            void * const ptr,
+            MemSizeType const bytes,
+            unsigned int const flags
+        )
+        -> Block *
+        {
+            auto& device = Device< DeviceType >::get();
+            const auto deviceId = device.id();
+            std::lock_guard< std::recursive_mutex > lock(
+                CacheBudget::get().mutex( deviceId )
+            );
+
+            MemVec< dim > const extent( bytes );
+            Block block( extent );
+            block.bytes = bytes;
+            block.registered = true;
+            // page locked by cudaHostRegister(), CPU memory needs no pinning
+            block.pinned = true;
+            block.mapping = std::shared_ptr< uint8_t >(
+                static_cast< uint8_t * >( ptr ),
+                []( uint8_t * ){ }
+            );
+            // registered memory is not limited by the capacity
+            return this->insert( deviceId, std::move( block ), extent, flags );
+        }
+
+        /** remove memory registered with registerMemory()
+         *
+         * @return false if ptr is not the pointer of registered memory
+         */
+        auto
+        unregisterMemory( void * const ptr )
+        -> bool
+        {
+            auto& device = Device< DeviceType >::get();
+            const auto deviceId = device.id();
+            std::lock_guard< std::recursive_mutex > lock(
+                CacheBudget::get().mutex( deviceId )
+            );
+
+            auto iter = m_mapVector[ deviceId ].find(
+                static_cast< uint8_t * >( ptr )
+            );
+            if(
+                iter == m_mapVector[ deviceId ].end() ||
+                !iter->second.registered
+            )
+                return false;
+
+            PointerRegistry::get().erase( ptr );
+            m_mapVector[ deviceId ].erase( iter );
+            return true;
+        }
+
+        /** move the stream ordered cache of a stream to the device cache
+         *
+         * Must be called before a stream is destroyed.
+         */
+        void
+        releaseStream( cuplaStream_t const streamId )
+        {
+            this->releaseStream(
+                streamId,
+                Device< DeviceType >::get().id()
+            );
+        }
+
+        //! release a stream of the device `deviceId`
+        void
+        releaseStream(
+            cuplaStream_t const streamId,
+            int const deviceId
+        )
+        {
+            std::lock_guard< std::recursive_mutex > lock(
+                CacheBudget::get().mutex( deviceId )
+            );
+            auto& streamCaches = m_streamCacheVector[ deviceId ];
+
+            auto streamCache = streamCaches.find( streamId );
+            if( streamCache != streamCaches.end() )
+            {
+                for( auto& entry : streamCache->second )
+                    m_cacheVector[ deviceId ].insert( std::move( entry ) );
+                streamCaches.erase( streamCache );
+            }
+        }
+
+        /** release cached memory of the current device
+         *
+         * The largest blocks are released first, blocks which can still be
+         * used by a stream are skipped. Released blocks with finished work
+         * are deleted.
+         *
+         * @param minBytesToKeep number of cached bytes (of all dimensions)
+         *                       which can be kept
+         */
+        void
+        trim( MemSizeType const minBytesToKeep = 0u )
+        {
+            auto& device = Device< DeviceType >::get();
+            const auto deviceId = device.id();
+            std::lock_guard< std::recursive_mutex > lock(
+                CacheBudget::get().mutex( deviceId )
+            );
+
+            this->releasePending( deviceId );
+            this->trimCache(
+                m_cacheVector[ deviceId ],
+                deviceId,
+                minBytesToKeep
+            );
+            for( auto& streamCache : m_streamCacheVector[ deviceId ] )
+                this->trimCache(
+                    streamCache.second,
+                    deviceId,
+                    minBytesToKeep
+                );
+        }
+
         /** delete all memory on the current device
          *
          * @return true in success case else false
@@ -130,17 +888,310 @@ namespace manager
         {
             auto& device = Device< DeviceType >::get();
             const auto deviceId = device.id();
+            std::lock_guard< std::recursive_mutex > lock(
+                CacheBudget::get().mutex( deviceId )
+            );
 
+            for( auto const & entry : m_mapVector[ deviceId ] )
+            {
+                PointerRegistry::get().erase( entry.first );
+                AllocationTracer::get().recordFree( entry.first, 0 );
+                if( !entry.second.registered )
+                    CacheBudget::get().removeLive( deviceId, entry.second.requestedBytes );
+            }
             m_mapVector[ deviceId ].clear( );
+            for( auto& streamCache : m_streamCacheVector[ deviceId ] )
+                for( auto& entry : streamCache.second )
+                    m_cacheVector[ deviceId ].insert( std::move( entry ) );
+            m_streamCacheVector[ deviceId ].clear( );
+            this->trim( );
 
             // @todo: check if clear creates errors
             return true;
         }
 
     protected:
-        Memory() : m_mapVector( Device< DeviceType >::get().count() )
+        Memory() :
+            m_mapVector( Device< DeviceType >::get().count() ),
+            m_cacheVector( Device< DeviceType >::get().count() ),
+            m_streamCacheVector( Device< DeviceType >::get().count() ),
+            m_pendingVector( Device< DeviceType >::get().count() )
+        {
+
+        }
+
+    private:
+
+        /** register a block as used, allocate it if it holds no memory
+         *
+         * @param requestedExtent extent requested by the application, the
+         *                        extent of the block can be larger
+         * @param streamId stream of a stream ordered allocation
+         * @return nullptr if the block must be allocated and the capacity of
+         *         the device is exceeded
+         */
+        auto
+        insert(
+            int const deviceId,
+            Block && block,
+            MemVec< dim > const & requestedExtent,
+            unsigned int const flags,
+            cuplaStream_t const streamId = 0
+        )
+        -> Block *
+        {
+            bool const isNew = !block.buf && !block.mapping;
+            auto& budget = CacheBudget::get();
+            // the unpitched size is a lower bound of the requested bytes
+            if( isNew && !budget.hasCapacity( deviceId, cacheKey( requestedExtent ) ) )
+            {
+                // cached memory counts to the capacity
+                this->trim( );
+                if( !budget.hasCapacity( deviceId, cacheKey( requestedExtent ) ) )
+                    return nullptr;
+            }
+            if( isNew && hugePagesSupported )
+            {
+                std::size_t bytes = cacheKey( block.extent );
+                bool const useHugePages =
+                    detail::HugePagePolicy::get().use( bytes, flags );
+                auto const placement =
+                    detail::NumaPolicy::get().placement( flags );
+
+                if( useHugePages )
+                    block.mapping = cupla::detail::mapHugePages(
+                        bytes,
+                        block.hugePages
+                    );
+                else if(
+                    placement != cuplaNumaPlacementDefault ||
+                    ( flags & cuplaMallocZeroInitialized )
+                )
+                    block.mapping = cupla::detail::mapPages( bytes );
+
+                if( block.mapping )
+                {
+                    block.bytes = bytes;
+                    if( placement == cuplaNumaPlacementFirstTouch )
+                    {
+                        detail::firstTouch( block.mapping.get(), bytes );
+                        block.numaPlacement = placement;
+                    }
+                    else
+                        block.numaPlacement = cupla::detail::applyNumaPlacement(
+                            block.mapping.get(),
+                            bytes,
+                            placement
+                        );
+                }
+            }
+            if( !block.buf && !block.mapping )
+            {
+                auto& device = Device< DeviceType >::get();
+                block.buf.reset(
+                    new BufType(
+                        ::alpaka::mem::buf::alloc<uint8_t, MemSizeType>(
+                            device.current(),
+                            block.extent
+                        )
+                    )
+                );
+                block.bytes = ::alpaka::mem::view::getPitchBytes< 0u >(
+                    *block.buf
+                );
+            }
+            /* 2D and 3D memory is accounted with the pitched size which is
+             * only known after the allocation, a rejected block is released
+             */
+            block.requestedBytes = dim == 1u ? requestedExtent[ 0 ] : block.bytes;
+            if( isNew && !budget.hasCapacity( deviceId, block.requestedBytes ) )
+            {
+                this->trim( );
+                if( !budget.hasCapacity( deviceId, block.requestedBytes ) )
+                    return nullptr;
+            }
+
+            uint8_t *nativePtr = block.ptr();
+
+            PointerRegistry::Record record;
+            record.base = nativePtr;
+            record.size = block.requestedBytes;
+            record.dim = dim;
+            record.pitch = dim == 1u ? block.requestedBytes : block.pitch();
+            record.device = deviceId;
+            record.type = memoryType;
+            record.flags = flags;
+            record.registered = block.registered;
+            record.hugePages = block.hugePages;
+            record.numaPlacement = block.numaPlacement;
+            // fresh anonymous mappings are demand zero pages
+            record.pristine = isNew && block.mapping &&
+                ( flags & cuplaMallocZeroInitialized );
+            record.epoch = PointerRegistry::writeEpoch().load();
+
+            if( block.registered )
+            {
+                // the application can register the same memory concurrently
+                if( !PointerRegistry::get().insertIfDisjoint( record ) )
+                    return nullptr;
+            }
+            else
+            {
+                PointerRegistry::get().insert( record );
+                budget.addLive( deviceId, block.requestedBytes, !isNew );
+                AllocationTracer::get().recordAlloc(
+                    nativePtr,
+                    block.requestedBytes,
+                    dim,
+                    deviceId,
+                    memoryType,
+                    streamId
+                );
+            }
+
+            return &m_mapVector[ deviceId ].insert(
+                std::make_pair( nativePtr, std::move( block ) )
+            ).first->second;
+        }
+
+        /** extent which is allocated for a requested extent, used as key
+         *  of the cache
+         */
+        static auto
+        cacheExtent( MemVec< dim > const & extent )
+        -> MemVec< dim >
         {
+            MemVec< dim > result( extent );
+            if( dim == 1u )
+                result[ 0 ] = detail::sizeClass( extent[ 0 ] );
+            return result;
+        }
 
+        static auto
+        cacheKey( MemVec< dim > const & extent )
+        -> MemSizeType
+        {
+            MemSizeType key = 1u;
+            for( uint32_t d = 0u; d < dim; ++d )
+                key *= extent[ d ];
+            return key;
+        }
+
+        /** check if a cached block fulfills the huge page and NUMA request
+         *  of flags
+         */
+        static auto
+        fulfills(
+            Block const & cached,
+            unsigned int const flags
+        )
+        -> bool
+        {
+            if( !hugePagesSupported )
+                return true;
+
+            auto const placement = detail::NumaPolicy::get().placement( flags );
+            if(
+                placement != cuplaNumaPlacementDefault &&
+                cached.numaPlacement != placement
+            )
+                return false;
+
+            // without transparent huge pages a new block has most likely none
+            if( detail::HugePagePolicy::get().use( cacheKey( cached.extent ), flags ) )
+                return cached.hugePages != cuplaHugePageNone ||
+                    !cupla::detail::transparentHugePagesEnabled();
+            if( flags & cuplaMallocNoHugePages )
+                return cached.hugePages == cuplaHugePageNone;
+            return true;
+        }
+
+        /** move a cached block with a matching extent to `block`
+         *
+         * @param flags allocation flags the block must fulfill
+         * @param mustBeReady if true only blocks without pending work are used
+         * @return true if a cached block was found else false
+         */
+        auto
+        takeFromCache(
+            CacheMap & cache,
+            int const deviceId,
+            Block & block,
+            unsigned int const flags,
+            bool const mustBeReady = true
+        )
+        -> bool
+        {
+            auto range = cache.equal_range( cacheKey( block.extent ) );
+            for( auto iter = range.first; iter != range.second; ++iter )
+            {
+                bool isEqual = fulfills( iter->second, flags );
+                for( uint32_t d = 0u; d < dim; ++d )
+                    isEqual = isEqual && iter->second.extent[ d ] == block.extent[ d ];
+                if( isEqual && ( !mustBeReady || iter->second.ready() ) )
+                {
+                    block = std::move( iter->second );
+                    CacheBudget::get().m_cachedBytes[ deviceId ] -= block.bytes;
+                    cache.erase( iter );
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        //! keep a released block until its work is finished
+        void
+        deferRelease(
+            int const deviceId,
+            Block && block
+        )
+        {
+            CacheBudget::get().m_pendingBytes[ deviceId ] += block.bytes;
+            m_pendingVector[ deviceId ].push_back( std::move( block ) );
+        }
+
+        //! delete released blocks of the device whose work is finished
+        void
+        releasePending( int const deviceId )
+        {
+            auto& pending = m_pendingVector[ deviceId ];
+            auto& pendingBytes = CacheBudget::get().m_pendingBytes[ deviceId ];
+
+            auto iter = pending.begin();
+            while( iter != pending.end() )
+            {
+                if( iter->ready() )
+                {
+                    pendingBytes -= iter->bytes;
+                    iter = pending.erase( iter );
+                }
+                else
+                    ++iter;
+            }
+        }
+
+        void
+        trimCache(
+            CacheMap & cache,
+            int const deviceId,
+            MemSizeType const minBytesToKeep
+        )
+        {
+            auto& budget = CacheBudget::get();
+
+            auto iter = cache.end();
+            while(
+                iter != cache.begin() &&
+                budget.m_cachedBytes[ deviceId ] > minBytesToKeep
+            )
+            {
+                --iter;
+                if( iter->second.ready() )
+                {
+                    budget.m_cachedBytes[ deviceId ] -= iter->second.bytes;
+                    iter = cache.erase( iter );
+                }
+            }
         }
 
     };
@@ -0,0 +1,500 @@
+/**
+ * Copyright 2016 Rene Widera
+ *
+ * This file is part of cupla.
+ *
+ * cupla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cupla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cupla.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include "cupla/types.hpp"
+#include "cupla_driver_types.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace cupla
+{
+namespace manager
+{
+
+    /** registry of all memory allocated by the memory managers
+     *
+     * The registry is shared by all devices and memory types. Base pointers
+     * are resolved with a hash lookup, interior pointers with a search in an
+     * ordered interval index.
+     *
+     * The records are distributed to shards by their base pointer. The
+     * interval index is split into address regions of `regionSize` bytes,
+     * an allocation is indexed in the shard of each region it covers. Each
+     * shard has an own mutex, records are returned by value and modified
+     * only while the shard is locked.
+     */
+    struct PointerRegistry
+    {
+        struct Record
+        {
+            uint8_t * base;
+            MemSizeType size;
+            uint32_t dim;
+            //! pitch of a row in bytes
+            MemSizeType pitch;
+            int device;
+            cuplaMemoryType type;
+            //! allocation flags, e.g. cuplaHostAllocMapped
+            unsigned int flags;
+            //! memory is owned by the application, flags are register flags
+            bool registered;
+            cuplaHugePageType hugePages;
+            cuplaNumaPlacement numaPlacement;
+            /** memory is zero filled and was not written by cupla since
+             *  the write epoch `epoch`
+             */
+            bool pristine;
+            uint64_t epoch;
+        };
+
+        using RecordMap = std::unordered_map<
+            uint8_t const *,
+            Record
+        >;
+
+        //! base pointer to the first byte behind the allocation
+        using IntervalMap = std::map<
+            uint8_t const *,
+            uint8_t const *
+        >;
+
+        //! must be 16, see shard()
+        static constexpr std::size_t numShards = 16u;
+
+        //! log2 of the bytes of an address region of the interval index
+        static constexpr unsigned int regionBits = 21u;
+
+        struct Shard
+        {
+            RecordMap records;
+            std::mutex mutex;
+        };
+
+        struct IntervalShard
+        {
+            IntervalMap intervals;
+            std::mutex mutex;
+        };
+
+        Shard m_shards[ numShards ];
+        IntervalShard m_intervalShards[ numShards ];
+
+        static auto
+        get()
+        -> PointerRegistry &
+        {
+            static PointerRegistry registry;
+            return registry;
+        }
+
+        /** counter of operations which can write to any memory
+         *
+         * Increased by each kernel launch and each write to an interior
+         * pointer, a pristine allocation is only zero filled as long as the
+         * epoch is not changed.
+         */
+        static auto
+        writeEpoch()
+        -> std::atomic< uint64_t > &
+        {
+            static std::atomic< uint64_t > epoch( 0u );
+            return epoch;
+        }
+
+        void
+        insert( Record const & record )
+        {
+            {
+                Shard & shard = this->shard( record.base );
+                std::lock_guard< std::mutex > lock( shard.mutex );
+                shard.records[ record.base ] = record;
+            }
+            this->forEachIntervalShard(
+                record.base,
+                record.size,
+                [ &record ]( IntervalShard & intervalShard )
+                {
+                    std::lock_guard< std::mutex > lock( intervalShard.mutex );
+                    intervalShard.intervals[ record.base ] =
+                        record.base + record.size;
+                }
+            );
+        }
+
+        /** insert an allocation if it overlaps no registered allocation
+         *
+         * The check and the insert are one atomic operation.
+         *
+         * @return false if the allocation overlaps with a registered one
+         */
+        auto
+        insertIfDisjoint( Record const & record )
+        -> bool
+        {
+            bool isCovered[ numShards ] = { };
+            this->forEachIntervalShard(
+                record.base,
+                record.size,
+                [ this, &isCovered ]( IntervalShard & intervalShard )
+                {
+                    isCovered[ &intervalShard - m_intervalShards ] = true;
+                }
+            );
+
+            // locked in the order of the shards to avoid dead locks
+            std::unique_lock< std::mutex > locks[ numShards ];
+            for( std::size_t i = 0u; i < numShards; ++i )
+                if( isCovered[ i ] )
+                    locks[ i ] = std::unique_lock< std::mutex >(
+                        m_intervalShards[ i ].mutex
+                    );
+
+            for( std::size_t i = 0u; i < numShards; ++i )
+                if(
+                    isCovered[ i ] &&
+                    overlapsInterval(
+                        m_intervalShards[ i ].intervals,
+                        record.base,
+                        record.size
+                    )
+                )
+                    return false;
+
+            {
+                Shard & shard = this->shard( record.base );
+                std::lock_guard< std::mutex > lock( shard.mutex );
+                shard.records[ record.base ] = record;
+            }
+            for( std::size_t i = 0u; i < numShards; ++i )
+                if( isCovered[ i ] )
+                    m_intervalShards[ i ].intervals[ record.base ] =
+                        record.base + record.size;
+            return true;
+        }
+
+        /** remove an allocation
+         *
+         * @param base base pointer of the allocation
+         * @return true if the pointer was registered else false
+         */
+        auto
+        erase( void const * base )
+        -> bool
+        {
+            auto const ptr = static_cast< uint8_t const * >( base );
+            MemSizeType size = 0u;
+            {
+                Shard & shard = this->shard( ptr );
+                std::lock_guard< std::mutex > lock( shard.mutex );
+                auto iter = shard.records.find( ptr );
+                if( iter == shard.records.end() )
+                    return false;
+                size = iter->second.size;
+                shard.records.erase( iter );
+            }
+            this->forEachIntervalShard(
+                ptr,
+                size,
+                [ ptr ]( IntervalShard & intervalShard )
+                {
+                    std::lock_guard< std::mutex > lock( intervalShard.mutex );
+                    intervalShard.intervals.erase( ptr );
+                }
+            );
+            return true;
+        }
+
+        /** find an allocation by its base pointer
+         *
+         * @param[out] record copy of the record, unchanged if not found
+         * @return false if ptr is not the base pointer of an allocation
+         */
+        auto
+        findBase(
+            void const * ptr,
+            Record & record
+        ) const
+        -> bool
+        {
+            return this->modifyBase(
+                ptr,
+                [ &record ]( Record & found ){ record = found; }
+            );
+        }
+
+        /** find the allocation which contains a pointer
+         *
+         * @param[out] record copy of the record, unchanged if not found
+         * @return false if ptr is not part of an allocation
+         */
+        auto
+        find(
+            void const * ptr,
+            Record & record
+        ) const
+        -> bool
+        {
+            if( this->findBase( ptr, record ) )
+                return true;
+
+            uint8_t const * const base = this->findIntervalBase( ptr );
+            return base != nullptr && this->findBase( base, record );
+        }
+
+        //! check if any allocation overlaps with [ptr;ptr+size)
+        auto
+        overlaps(
+            void const * ptr,
+            MemSizeType const size
+        ) const
+        -> bool
+        {
+            auto const bytePtr = static_cast< uint8_t const * >( ptr );
+            bool result = false;
+            this->forEachIntervalShard(
+                bytePtr,
+                size,
+                [ bytePtr, size, &result ]( IntervalShard & intervalShard )
+                {
+                    std::lock_guard< std::mutex > lock( intervalShard.mutex );
+                    result = result ||
+                        overlapsInterval( intervalShard.intervals, bytePtr, size );
+                }
+            );
+            return result;
+        }
+
+        /** check if the allocation based at ptr is still zero filled
+         *
+         * Interior pointers are never pristine.
+         */
+        auto
+        isPristine( void const * ptr ) const
+        -> bool
+        {
+            Record record;
+            return this->findBase( ptr, record ) &&
+                record.pristine &&
+                record.epoch == writeEpoch().load();
+        }
+
+        /** mark the allocation containing ptr as zero filled
+         *
+         * @return false if ptr is not part of an allocation
+         */
+        auto
+        markPristine( void const * ptr )
+        -> bool
+        {
+            return this->modify(
+                ptr,
+                []( Record & record )
+                {
+                    record.pristine = true;
+                    record.epoch = writeEpoch().load();
+                }
+            );
+        }
+
+        /** mark the memory at ptr as written
+         *
+         * Only base pointers are resolved, a write to any other pointer
+         * starts a new write epoch which ends the pristine state of all
+         * allocations.
+         */
+        void
+        markWritten( void const * ptr )
+        {
+            if(
+                !this->modifyBase(
+                    ptr,
+                    []( Record & record ){ record.pristine = false; }
+                )
+            )
+                ++writeEpoch();
+        }
+
+    protected:
+        PointerRegistry() = default;
+
+        /** call `func( record )` with the shard of the record locked
+         *
+         * @return false if ptr is not the base pointer of an allocation
+         */
+        template< typename T_Func >
+        auto
+        modifyBase(
+            void const * ptr,
+            T_Func const & func
+        ) const
+        -> bool
+        {
+            auto const bytePtr = static_cast< uint8_t const * >( ptr );
+            Shard & shard = this->shard( bytePtr );
+            std::lock_guard< std::mutex > lock( shard.mutex );
+            auto iter = shard.records.find( bytePtr );
+            if( iter == shard.records.end() )
+                return false;
+            func( iter->second );
+            return true;
+        }
+
+        /** call `func( record )` for the allocation containing ptr
+         *
+         * @return false if ptr is not part of an allocation
+         */
+        template< typename T_Func >
+        auto
+        modify(
+            void const * ptr,
+            T_Func const & func
+        )
+        -> bool
+        {
+            if( this->modifyBase( ptr, func ) )
+                return true;
+
+            uint8_t const * const base = this->findIntervalBase( ptr );
+            return base != nullptr && this->modifyBase( base, func );
+        }
+
+        /** base pointer of the allocation containing ptr
+         *
+         * @return nullptr if ptr is not part of an allocation
+         */
+        auto
+        findIntervalBase( void const * ptr ) const
+        -> uint8_t const *
+        {
+            auto const bytePtr = static_cast< uint8_t const * >( ptr );
+            IntervalShard & intervalShard = this->intervalShard(
+                region( bytePtr )
+            );
+            std::lock_guard< std::mutex > lock( intervalShard.mutex );
+            /* allocations do not overlap, the allocation containing ptr is
+             * the one with the greatest base not behind ptr
+             */
+            auto iter = intervalShard.intervals.upper_bound( bytePtr );
+            if( iter == intervalShard.intervals.begin() )
+                return nullptr;
+            --iter;
+            if( bytePtr >= iter->second )
+                return nullptr;
+            return iter->first;
+        }
+
+        static auto
+        overlapsInterval(
+            IntervalMap const & intervals,
+            uint8_t const * const ptr,
+            MemSizeType const size
+        )
+        -> bool
+        {
+            auto iter = intervals.lower_bound( ptr + size );
+            if( iter == intervals.begin() )
+                return false;
+            --iter;
+            return iter->second > ptr;
+        }
+
+        static auto
+        region( uint8_t const * const ptr )
+        -> std::uintptr_t
+        {
+            return reinterpret_cast< std::uintptr_t >( ptr ) >> regionBits;
+        }
+
+        /** call `func( intervalShard )` once for each interval shard of the
+         *  regions covered by [ptr;ptr+size)
+         */
+        template< typename T_Func >
+        void
+        forEachIntervalShard(
+            uint8_t const * const ptr,
+            MemSizeType const size,
+            T_Func const & func
+        ) const
+        {
+            std::uintptr_t const first = region( ptr );
+            std::uintptr_t const last = region( ptr + ( size == 0u ? 0u : size - 1u ) );
+            bool visited[ numShards ] = { };
+            for(
+                std::uintptr_t r = first;
+                r <= last && r - first < numShards * numShards;
+                ++r
+            )
+            {
+                std::size_t const index = shardIndex( r );
+                if( !visited[ index ] )
+                {
+                    visited[ index ] = true;
+                    func( const_cast< IntervalShard & >( m_intervalShards[ index ] ) );
+                }
+            }
+            // a large allocation covers all shards
+            if( last - first >= numShards * numShards )
+                for( std::size_t index = 0u; index < numShards; ++index )
+                    if( !visited[ index ] )
+                        func( const_cast< IntervalShard & >( m_intervalShards[ index ] ) );
+        }
+
+        /** Fibonacci hashing to one of the 16 shards, the low bits of page
+         *  aligned allocations are always zero
+         */
+        static auto
+        shardIndex( std::uintptr_t const key )
+        -> std::size_t
+        {
+            uint64_t const hash =
+                static_cast< uint64_t >( key ) * 0x9E3779B97F4A7C15ull;
+            return static_cast< std::size_t >( hash >> 60u );
+        }
+
+        auto
+        shard( uint8_t const * const base ) const
+        -> Shard &
+        {
+            return const_cast< Shard & >(
+                m_shards[ shardIndex( reinterpret_cast< std::uintptr_t >( base ) ) ]
+            );
+        }
+
+        auto
+        intervalShard( std::uintptr_t const r ) const
+        -> IntervalShard &
+        {
+            return const_cast< IntervalShard & >(
+                m_intervalShards[ shardIndex( r ) ]
+            );
+        }
+    };
+
+} //namespace manager
+} //namespace cupla
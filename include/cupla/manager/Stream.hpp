@@ -24,11 +24,22 @@
 
 #include "cupla/types.hpp"
 #include "cupla/manager/Device.hpp"
+#include "cupla/manager/Memory.hpp"
 #include "cupla_driver_types.hpp"
+#include "cupla/detail/SlotMap.hpp"
+#include "cupla/stream/Priority.hpp"
 
-#include <map>
 #include <vector>
 #include <memory>
+#include <functional>
+
+/** if set to 1 the default stream (handle 0) is the stream
+ * cuplaStreamPerThread of the calling host thread and does not synchronize
+ * with other streams
+ */
+#ifndef CUPLA_API_PER_THREAD_DEFAULT_STREAM
+#   define CUPLA_API_PER_THREAD_DEFAULT_STREAM 0
+#endif
 
 namespace cupla
 {
@@ -43,14 +54,32 @@ namespace manager
     {
         using DeviceType = T_DeviceType;
         using StreamType = T_StreamType;
+        using Priority = cupla::stream::traits::StreamPriority< StreamType >;
 
+        struct Entry
+        {
+            StreamType stream;
+            //! see StreamProp
+            unsigned int flags;
+            int priority;
 
-        using StreamMap = std::map<
-            cuplaStream_t,
-            std::unique_ptr<
-                StreamType
-            >
-        >;
+            template< typename T_Device >
+            Entry(
+                T_Device const & device,
+                unsigned int const streamFlags,
+                int const streamPriority
+            ) :
+                stream( device ),
+                flags( streamFlags ),
+                priority( streamPriority )
+            {
+                if( priority != Priority::least( ) )
+                    Priority::set( stream, priority );
+            }
+        };
+
+        //! the handle of a stream is the slot map handle
+        using StreamMap = cupla::detail::SlotMap< Entry >;
         using MapVector = std::vector< StreamMap >;
 
         MapVector m_mapVector;
@@ -63,54 +92,180 @@ namespace manager
             return stream;
         }
 
+        /** create a stream
+         *
+         * @param priority is clamped to the range of the stream type, a lower
+         *                 number is a higher priority
+         */
         auto
-        create( )
+        create(
+            unsigned int flags = cuplaStreamDefault,
+            int priority = 0
+        )
         -> cuplaStream_t
         {
-
             auto& device = Device< DeviceType >::get();
 
-            std::unique_ptr<
-                StreamType
-            > streamPtr(
-                new StreamType(
-                    device.current()
+            int const leastPriority = Priority::least( );
+            int const greatestPriority = Priority::greatest( );
+            if( priority > leastPriority )
+                priority = leastPriority;
+            if( priority < greatestPriority )
+                priority = greatestPriority;
+
+            return toStreamId(
+                m_mapVector[ device.id() ].insert(
+                    device.current(),
+                    flags,
+                    priority
                 )
             );
-            cuplaStream_t streamId = reinterpret_cast< cuplaStream_t >(
-                m_mapVector[ device.id() ].size()
-            );
-            m_mapVector[ device.id() ].insert(
-                std::make_pair( streamId, std::move( streamPtr ) )
-            );
-            return streamId;
         }
 
+        /** get a stream
+         *
+         * The default stream 0 is created with the first access. Handles
+         * are resolved with resolve().
+         *
+         * @return nullptr if the stream does not exist on the current device
+         */
         auto
         stream( cuplaStream_t streamId = 0 )
-        -> StreamType &
+        -> StreamType *
+        {
+            Entry * const result = this->entry( streamId );
+            return result == nullptr ? nullptr : &result->stream;
+        }
+
+        /** get a stream with its properties
+         *
+         * @return nullptr if the stream does not exist on the current device
+         */
+        auto
+        entry( cuplaStream_t streamId )
+        -> Entry *
         {
+            streamId = this->resolve( streamId );
             auto& device = Device< DeviceType >::get();
-            const auto deviceId = device.id();
-            auto iter = m_mapVector[ deviceId ].find(
-                streamId
-            );
+            auto& streamMap = m_mapVector[ device.id() ];
 
-            if( iter == m_mapVector[ device.id( ) ].end() )
+            Entry * result = streamMap.find( toHandle( streamId ) );
+            if( result == nullptr && streamId == 0 )
             {
-                if( streamId == 0 )
-                {
-                    this->create( );
-                    return this->stream( streamId );
-                }
-                else
+                // the default stream is created with the first access
+                streamMap.insertReserved(
+                    device.current(),
+                    cuplaStreamDefault,
+                    Priority::least( )
+                );
+                result = streamMap.find( 0u );
+            }
+            return result;
+        }
+
+        /** handle of the stream which is used for a handle
+         *
+         * cuplaStreamPerThread (and 0 if CUPLA_API_PER_THREAD_DEFAULT_STREAM
+         * is set) is resolved to the stream of the calling thread on the
+         * current device, the stream is created with the first access.
+         */
+        auto
+        resolve( cuplaStream_t const streamId )
+        -> cuplaStream_t
+        {
+            if(
+                streamId == cuplaStreamPerThread ||
+                ( CUPLA_API_PER_THREAD_DEFAULT_STREAM == 1 && streamId == 0 )
+            )
+                return this->perThreadStream( );
+            return streamId;
+        }
+
+        /** order the default stream after all blocking streams
+         *
+         * Work enqueued afterwards into the default stream starts after all
+         * work which is already enqueued into streams of the current device
+         * created without cuplaStreamNonBlocking (legacy default stream).
+         * With a per thread default stream nothing must be ordered.
+         *
+         * Only this direction is ordered: work enqueued into a blocking
+         * stream does not wait for asynchronous work in the default stream.
+         * The synchronous API calls wait for the default stream before they
+         * return, therefore the limitation affects asynchronous work only.
+         */
+        void
+        waitForBlockingStreams( )
+        {
+#if( CUPLA_API_PER_THREAD_DEFAULT_STREAM == 0 )
+            using EventType = ::alpaka::event::Event< StreamType >;
+
+            auto& device = Device< DeviceType >::get();
+            auto& defaultStream = *this->stream( 0 );
+
+            // the events are enqueued without holding the lock of the stream map
+            std::vector< StreamType > blockingStreams;
+            m_mapVector[ device.id() ].forEach(
+                [ &blockingStreams ](
+                    typename StreamMap::Handle const handle,
+                    Entry & entry
+                )
                 {
-                    std::cerr << "stream " << streamId <<
-                        " not exists on device "<< deviceId << std::endl;
+                    if( handle != 0u && !( entry.flags & cuplaStreamNonBlocking ) )
+                        blockingStreams.push_back( entry.stream );
                 }
+            );
+
+            for( auto & streamObject : blockingStreams )
+            {
+                EventType event( device.current() );
+                ::alpaka::stream::enqueue( streamObject, event );
+                ::alpaka::wait::wait( defaultStream, event );
             }
-            // @todo: check if stream was created
-            return *(iter->second);
+#endif
+        }
+
+        /** enqueue a completion marker into a stream
+         *
+         * @param streamObject stream returned by stream()
+         * @return functor which returns true if all work enqueued into the
+         *         stream before the marker is finished
+         */
+        auto
+        marker( StreamType & streamObject )
+        -> std::function< bool() >
+        {
+            using EventType = ::alpaka::event::Event< StreamType >;
+
+            auto& device = Device< DeviceType >::get();
+            std::shared_ptr< EventType > event(
+                new EventType( device.current() )
+            );
+            ::alpaka::stream::enqueue( streamObject, *event );
+
+            return [ event ]( ) -> bool
+            {
+                return ::alpaka::event::test( *event );
+            };
+        }
+
+        /** block until the work of all streams of the current device is
+         *  finished
+         *
+         * Only work enqueued before the call is waited for, the streams can
+         * be used concurrently.
+         */
+        void
+        synchronize( )
+        {
+            this->synchronize( Device< DeviceType >::get().id() );
+        }
+
+        //! block until the work of all streams of all devices is finished
+        void
+        synchronizeAll( )
+        {
+            for( std::size_t deviceId = 0u; deviceId < m_mapVector.size(); ++deviceId )
+                this->synchronize( static_cast< int >( deviceId ) );
         }
 
         auto
@@ -120,11 +275,7 @@ namespace manager
             auto& device = Device< DeviceType >::get();
             const auto deviceId = device.id();
 
-            auto iter = m_mapVector[ deviceId ].find(
-                streamId
-            );
-
-            if( iter == m_mapVector[ deviceId ].end() )
+            if( !m_mapVector[ deviceId ].erase( toHandle( streamId ) ) )
             {
                 std::cerr << "stream " << streamId <<
                     " can not destroyed (was never created) on device " <<
@@ -132,11 +283,7 @@ namespace manager
                     std::endl;
                 return false;
             }
-            else
-            {
-                m_mapVector[ deviceId ].erase( iter );
-                return true;
-            }
+            return true;
         }
 
 
@@ -157,10 +304,117 @@ namespace manager
         }
 
     protected:
+        //! wait for the streams of the device `deviceId`
+        void
+        synchronize( int const deviceId )
+        {
+            for( auto & streamObject : this->streams( deviceId ) )
+                ::alpaka::wait::wait( streamObject );
+        }
+
+        /** copies of all streams of a device
+         *
+         * A copy shares the state of the stream, work can be enqueued into
+         * the copies without holding the lock of the stream map.
+         */
+        auto
+        streams( int const deviceId )
+        -> std::vector< StreamType >
+        {
+            auto& streamMap = m_mapVector[ deviceId ];
+            std::vector< StreamType > result;
+            result.reserve( streamMap.size() );
+            streamMap.forEach(
+                [ &result ]( typename StreamMap::Handle, Entry & entry )
+                {
+                    result.push_back( entry.stream );
+                }
+            );
+            return result;
+        }
+
         Stream() :  m_mapVector( Device< DeviceType >::get().count() )
         {
         }
 
+        static auto
+        toHandle( cuplaStream_t const streamId )
+        -> typename StreamMap::Handle
+        {
+            return reinterpret_cast< typename StreamMap::Handle >( streamId );
+        }
+
+        static auto
+        toStreamId( typename StreamMap::Handle const handle )
+        -> cuplaStream_t
+        {
+            return reinterpret_cast< cuplaStream_t >( handle );
+        }
+
+        /** streams of a host thread, one per device
+         *
+         * The streams are destroyed after their work is finished if the
+         * thread exits.
+         */
+        struct PerThreadStreams
+        {
+            std::vector< cuplaStream_t > streamIds;
+
+            ~PerThreadStreams( )
+            {
+                auto& streams = Stream::get();
+                for( std::size_t deviceId = 0u; deviceId < streamIds.size(); ++deviceId )
+                {
+                    if( streamIds[ deviceId ] == 0 )
+                        continue;
+                    auto& streamMap = streams.m_mapVector[ deviceId ];
+                    auto const handle = toHandle( streamIds[ deviceId ] );
+                    Entry * const entry = streamMap.find( handle );
+                    if( entry == nullptr )
+                        continue;
+                    ::alpaka::wait::wait( entry->stream );
+                    /* release the stream ordered caches like cuplaStreamDestroy,
+                     * on the device of the stream instead of the current one
+                     */
+                    int const id = static_cast< int >( deviceId );
+                    Memory< DeviceType, AlpakaDim< 1u > >::get().releaseStream(
+                        streamIds[ deviceId ],
+                        id
+                    );
+                    Memory< DeviceType, AlpakaDim< 2u > >::get().releaseStream(
+                        streamIds[ deviceId ],
+                        id
+                    );
+                    Memory< DeviceType, AlpakaDim< 3u > >::get().releaseStream(
+                        streamIds[ deviceId ],
+                        id
+                    );
+                    streamMap.erase( handle );
+                }
+            }
+        };
+
+        //! handle of the default stream of the calling thread
+        auto
+        perThreadStream( )
+        -> cuplaStream_t
+        {
+            auto& device = Device< DeviceType >::get();
+            static thread_local PerThreadStreams perThread;
+            auto& streamIds = perThread.streamIds;
+            if( streamIds.empty() )
+                streamIds.resize( device.count(), 0 );
+
+            cuplaStream_t & streamId = streamIds[ device.id() ];
+            // not created yet or deleted by reset()
+            if(
+                streamId == 0 ||
+                m_mapVector[ device.id() ].find( toHandle( streamId ) ) == nullptr
+            )
+                streamId = this->create( );
+            return streamId;
+        }
+
     };
 
 } //namespace manager
@@ -0,0 +1,137 @@
+/**
+ * Copyright 2016 Rene Widera
+ *
+ * This file is part of cupla.
+ *
+ * cupla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cupla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cupla.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#pragma once
+
+#include <alpaka/alpaka.hpp>
+
+namespace cupla
+{
+namespace stream
+{
+namespace traits
+{
+
+    /** priorities of a stream type
+     *
+     * A lower number is a higher priority. Stream types without priorities
+     * support only the priority 0.
+     */
+    template<
+        typename T_Stream,
+        typename T_Sfinae = void
+    >
+    struct StreamPriority
+    {
+        static auto
+        least( )
+        -> int
+        {
+            return 0;
+        }
+
+        static auto
+        greatest( )
+        -> int
+        {
+            return 0;
+        }
+
+        //! set the priority of a new stream, the priority is in the range
+        static void
+        set(
+            T_Stream &,
+            int const
+        )
+        { }
+    };
+
+#if defined(ALPAKA_ACC_GPU_CUDA_ENABLED)
+    /** native CUDA stream priorities of the current device
+     *
+     * alpaka creates CUDA streams without a priority, therefore the native
+     * stream of a prioritized stream is replaced.
+     */
+    template<>
+    struct StreamPriority< ::alpaka::stream::StreamCudaRtAsync >
+    {
+        static auto
+        least( )
+        -> int
+        {
+            int leastPriority = 0;
+            int greatestPriority = 0;
+            ALPAKA_CUDA_RT_CHECK(
+                cudaDeviceGetStreamPriorityRange(
+                    &leastPriority,
+                    &greatestPriority
+                )
+            );
+            return leastPriority;
+        }
+
+        static auto
+        greatest( )
+        -> int
+        {
+            int leastPriority = 0;
+            int greatestPriority = 0;
+            ALPAKA_CUDA_RT_CHECK(
+                cudaDeviceGetStreamPriorityRange(
+                    &leastPriority,
+                    &greatestPriority
+                )
+            );
+            return greatestPriority;
+        }
+
+        static void
+        set(
+            ::alpaka::stream::StreamCudaRtAsync & stream,
+            int const priority
+        )
+        {
+            auto & streamImpl = *stream.m_spStreamImpl;
+            ALPAKA_CUDA_RT_CHECK(
+                cudaSetDevice( streamImpl.m_dev.m_iDevice )
+            );
+            cudaStream_t prioritizedStream;
+            // alpaka streams are not synchronized with the CUDA default stream
+            ALPAKA_CUDA_RT_CHECK(
+                cudaStreamCreateWithPriority(
+                    &prioritizedStream,
+                    cudaStreamNonBlocking,
+                    priority
+                )
+            );
+            ALPAKA_CUDA_RT_CHECK(
+                cudaStreamDestroy( streamImpl.m_CudaStream )
+            );
+            streamImpl.m_CudaStream = prioritizedStream;
+        }
+    };
+#endif
+
+} // namespace traits
+} // namespace stream
+} // namespace cupla
@@ -0,0 +1,484 @@
+/**
+ * Copyright 2016 Rene Widera
+ *
+ * This file is part of cupla.
+ *
+ * cupla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cupla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cupla.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#pragma once
+
+#include "cupla/stream/WorkerPool.hpp"
+#include "cupla/stream/Priority.hpp"
+
+#include <alpaka/alpaka.hpp>
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace cupla
+{
+namespace stream
+{
+namespace detail
+{
+
+    class EventCpuPoolImpl
+    {
+    public:
+        EventCpuPoolImpl( ::alpaka::dev::DevCpu const & dev ) :
+            m_dev( dev ),
+            m_enqueueCount( 0u ),
+            m_readyCount( 0u )
+        { }
+
+        //! @return number of the new enqueue operation
+        auto
+        enqueue( )
+        -> std::size_t
+        {
+            std::lock_guard< std::mutex > lock( m_mutex );
+            return ++m_enqueueCount;
+        }
+
+        //! mark an enqueue operation and all before it as finished
+        void
+        ready( std::size_t const enqueueCount )
+        {
+            std::vector< std::function< void() > > resumed;
+            {
+                std::lock_guard< std::mutex > lock( m_mutex );
+                m_readyCount = std::max( m_readyCount, enqueueCount );
+                auto iter = m_waiters.begin( );
+                while( iter != m_waiters.end( ) )
+                {
+                    if( iter->first <= m_readyCount )
+                    {
+                        resumed.push_back( std::move( iter->second ) );
+                        iter = m_waiters.erase( iter );
+                    }
+                    else
+                        ++iter;
+                }
+            }
+            m_readyCond.notify_all( );
+            for( auto const & resume : resumed )
+                resume( );
+        }
+
+        auto
+        test( ) const
+        -> bool
+        {
+            std::lock_guard< std::mutex > lock( m_mutex );
+            return m_readyCount >= m_enqueueCount;
+        }
+
+        //! block until the last enqueue operation is finished
+        void
+        wait( )
+        {
+            std::unique_lock< std::mutex > lock( m_mutex );
+            std::size_t const enqueueCount = m_enqueueCount;
+            m_readyCond.wait(
+                lock,
+                [ & ]( ){ return m_readyCount >= enqueueCount; }
+            );
+        }
+
+        /** condition of a queue which waits for the last enqueue operation
+         *
+         * @return empty if the event is already finished
+         */
+        auto
+        gate( std::shared_ptr< EventCpuPoolImpl > const & self )
+        -> WorkerPool::Gate
+        {
+            std::size_t enqueueCount;
+            {
+                std::lock_guard< std::mutex > lock( m_mutex );
+                if( m_readyCount >= m_enqueueCount )
+                    return WorkerPool::Gate( );
+                enqueueCount = m_enqueueCount;
+            }
+            return [ self, enqueueCount ](
+                std::function< void() > const & resume
+            ) -> bool
+            {
+                std::lock_guard< std::mutex > lock( self->m_mutex );
+                if( self->m_readyCount >= enqueueCount )
+                    return true;
+                self->m_waiters.emplace_back( enqueueCount, resume );
+                return false;
+            };
+        }
+
+        ::alpaka::dev::DevCpu const m_dev;
+
+    private:
+        mutable std::mutex m_mutex;
+        std::condition_variable m_readyCond;
+        std::size_t m_enqueueCount;
+        std::size_t m_readyCount;
+        //! queues parked until an enqueue operation is finished
+        std::vector<
+            std::pair<
+                std::size_t,
+                std::function< void() >
+            >
+        > m_waiters;
+    };
+
+    struct StreamCpuPoolImpl
+    {
+        StreamCpuPoolImpl( ::alpaka::dev::DevCpu const & dev ) :
+            m_dev( dev ),
+            m_pool( WorkerPool::get( ) ),
+            m_queue( m_pool->createQueue( ) )
+        { }
+
+        ::alpaka::dev::DevCpu const m_dev;
+        std::shared_ptr< WorkerPool > const m_pool;
+        WorkerPool::TaskQueuePtr const m_queue;
+    };
+
+} // namespace detail
+
+    /** asynchronous stream for the CPU device executed by a shared pool
+     *
+     * Alternative to ::alpaka::stream::StreamCpuAsync which owns an own
+     * thread. All pooled streams share the threads of detail::WorkerPool,
+     * creating a stream is cheap and the number of threads is bounded. Work
+     * of a stream is executed in order, events work like alpaka CPU events.
+     * Work left in a destroyed stream is executed.
+     */
+    class StreamCpuPool
+    {
+    public:
+        StreamCpuPool( ::alpaka::dev::DevCpu const & dev ) :
+            m_spStreamImpl( std::make_shared< detail::StreamCpuPoolImpl >( dev ) )
+        { }
+
+        auto
+        operator==( StreamCpuPool const & rhs ) const
+        -> bool
+        {
+            return m_spStreamImpl == rhs.m_spStreamImpl;
+        }
+
+        auto
+        operator!=( StreamCpuPool const & rhs ) const
+        -> bool
+        {
+            return !( *this == rhs );
+        }
+
+        void
+        enqueue( std::function< void() > work )
+        {
+            detail::WorkerPool::Task task;
+            task.work = std::move( work );
+            m_spStreamImpl->m_pool->enqueue(
+                m_spStreamImpl->m_queue,
+                std::move( task )
+            );
+        }
+
+        //! delay the following work until `gate` is passed
+        void
+        enqueueGate( detail::WorkerPool::Gate gate )
+        {
+            detail::WorkerPool::Task task;
+            task.gate = std::move( gate );
+            m_spStreamImpl->m_pool->enqueue(
+                m_spStreamImpl->m_queue,
+                std::move( task )
+            );
+        }
+
+        std::shared_ptr< detail::StreamCpuPoolImpl > m_spStreamImpl;
+    };
+
+    //! event of a StreamCpuPool
+    class EventCpuPool
+    {
+    public:
+        EventCpuPool( ::alpaka::dev::DevCpu const & dev ) :
+            m_spEventImpl( std::make_shared< detail::EventCpuPoolImpl >( dev ) )
+        { }
+
+        auto
+        operator==( EventCpuPool const & rhs ) const
+        -> bool
+        {
+            return m_spEventImpl == rhs.m_spEventImpl;
+        }
+
+        auto
+        operator!=( EventCpuPool const & rhs ) const
+        -> bool
+        {
+            return !( *this == rhs );
+        }
+
+        std::shared_ptr< detail::EventCpuPoolImpl > m_spEventImpl;
+    };
+
+namespace traits
+{
+
+    //! priorities of the worker pool
+    template<>
+    struct StreamPriority< StreamCpuPool >
+    {
+        static auto
+        least( )
+        -> int
+        {
+            return detail::WorkerPool::leastPriority( );
+        }
+
+        static auto
+        greatest( )
+        -> int
+        {
+            return detail::WorkerPool::greatestPriority( );
+        }
+
+        static void
+        set(
+            StreamCpuPool & stream,
+            int const priority
+        )
+        {
+            stream.m_spStreamImpl->m_queue->setPriority( priority );
+        }
+    };
+
+} // namespace traits
+} // namespace stream
+} // namespace cupla
+
+
+namespace alpaka
+{
+namespace dev
+{
+namespace traits
+{
+
+    template<>
+    struct DevType< ::cupla::stream::StreamCpuPool >
+    {
+        using type = ::alpaka::dev::DevCpu;
+    };
+
+    template<>
+    struct GetDev< ::cupla::stream::StreamCpuPool >
+    {
+        ALPAKA_FN_HOST
+        static auto
+        getDev( ::cupla::stream::StreamCpuPool const & stream )
+        -> ::alpaka::dev::DevCpu
+        {
+            return stream.m_spStreamImpl->m_dev;
+        }
+    };
+
+    template<>
+    struct DevType< ::cupla::stream::EventCpuPool >
+    {
+        using type = ::alpaka::dev::DevCpu;
+    };
+
+    template<>
+    struct GetDev< ::cupla::stream::EventCpuPool >
+    {
+        ALPAKA_FN_HOST
+        static auto
+        getDev( ::cupla::stream::EventCpuPool const & event )
+        -> ::alpaka::dev::DevCpu
+        {
+            return event.m_spEventImpl->m_dev;
+        }
+    };
+
+} // namespace traits
+} // namespace dev
+
+namespace event
+{
+namespace traits
+{
+
+    template<>
+    struct EventType< ::cupla::stream::StreamCpuPool >
+    {
+        using type = ::cupla::stream::EventCpuPool;
+    };
+
+    template<>
+    struct Test< ::cupla::stream::EventCpuPool >
+    {
+        ALPAKA_FN_HOST
+        static auto
+        test( ::cupla::stream::EventCpuPool const & event )
+        -> bool
+        {
+            return event.m_spEventImpl->test( );
+        }
+    };
+
+} // namespace traits
+} // namespace event
+
+namespace stream
+{
+namespace traits
+{
+
+    //! enqueue a task, e.g. a kernel or a memory copy
+    template< typename TTask >
+    struct Enqueue<
+        ::cupla::stream::StreamCpuPool,
+        TTask
+    >
+    {
+        ALPAKA_FN_HOST
+        static auto
+        enqueue(
+            ::cupla::stream::StreamCpuPool & stream,
+            TTask const & task
+        )
+        -> void
+        {
+            stream.enqueue(
+                [ task ]( )
+                {
+                    task( );
+                }
+            );
+        }
+    };
+
+    template<>
+    struct Enqueue<
+        ::cupla::stream::StreamCpuPool,
+        ::cupla::stream::EventCpuPool
+    >
+    {
+        ALPAKA_FN_HOST
+        static auto
+        enqueue(
+            ::cupla::stream::StreamCpuPool & stream,
+            ::cupla::stream::EventCpuPool const & event
+        )
+        -> void
+        {
+            auto const spEventImpl = event.m_spEventImpl;
+            std::size_t const enqueueCount = spEventImpl->enqueue( );
+            stream.enqueue(
+                [ spEventImpl, enqueueCount ]( )
+                {
+                    spEventImpl->ready( enqueueCount );
+                }
+            );
+        }
+    };
+
+    template<>
+    struct Empty< ::cupla::stream::StreamCpuPool >
+    {
+        ALPAKA_FN_HOST
+        static auto
+        empty( ::cupla::stream::StreamCpuPool const & stream )
+        -> bool
+        {
+            return stream.m_spStreamImpl->m_queue->empty( );
+        }
+    };
+
+} // namespace traits
+} // namespace stream
+
+namespace wait
+{
+namespace traits
+{
+
+    //! block the calling thread until the work of the stream is finished
+    template<>
+    struct CurrentThreadWaitFor< ::cupla::stream::StreamCpuPool >
+    {
+        ALPAKA_FN_HOST
+        static auto
+        currentThreadWaitFor( ::cupla::stream::StreamCpuPool const & stream )
+        -> void
+        {
+            ::cupla::stream::EventCpuPool event( stream.m_spStreamImpl->m_dev );
+            ::alpaka::stream::enqueue(
+                const_cast< ::cupla::stream::StreamCpuPool & >( stream ),
+                event
+            );
+            event.m_spEventImpl->wait( );
+        }
+    };
+
+    template<>
+    struct CurrentThreadWaitFor< ::cupla::stream::EventCpuPool >
+    {
+        ALPAKA_FN_HOST
+        static auto
+        currentThreadWaitFor( ::cupla::stream::EventCpuPool const & event )
+        -> void
+        {
+            event.m_spEventImpl->wait( );
+        }
+    };
+
+    /** delay the following work of a stream until the event is finished
+     *
+     * The stream is parked without blocking a worker of the pool.
+     */
+    template<>
+    struct WaiterWaitFor<
+        ::cupla::stream::StreamCpuPool,
+        ::cupla::stream::EventCpuPool
+    >
+    {
+        ALPAKA_FN_HOST
+        static auto
+        waiterWaitFor(
+            ::cupla::stream::StreamCpuPool & stream,
+            ::cupla::stream::EventCpuPool const & event
+        )
+        -> void
+        {
+            auto gate = event.m_spEventImpl->gate( event.m_spEventImpl );
+            if( gate )
+                stream.enqueueGate( std::move( gate ) );
+        }
+    };
+
+} // namespace traits
+} // namespace wait
+} // namespace alpaka
@@ -0,0 +1,338 @@
+/**
+ * Copyright 2016 Rene Widera
+ *
+ * This file is part of cupla.
+ *
+ * cupla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cupla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cupla.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace cupla
+{
+namespace stream
+{
+namespace detail
+{
+
+    /** fixed set of host threads which executes the work of many streams
+     *
+     * Each stream owns a TaskQueue. A queue with work is scheduled in the
+     * pool, a worker executes one task of a scheduled queue and schedules the
+     * queue again if it holds more work. The tasks of a queue are executed
+     * in order and never concurrently.
+     *
+     * Each queue has a priority, a lower number is a higher priority (like
+     * CUDA stream priorities). Workers always take a queue of the highest
+     * priority which has work, so queued tasks of a higher priority are
+     * executed before tasks of a lower priority at task boundaries. Queues of
+     * the same priority progress round robin.
+     *
+     * CUPLA_STREAM_POOL_THREADS is the number of worker threads, the default
+     * is the number of cores but at most 4.
+     */
+    class WorkerPool
+    {
+    public:
+
+        /** condition a queue waits for before it executes the next task
+         *
+         * Called with a functor which resumes the queue.
+         *
+         * @return true if the queue can proceed, else false and the functor
+         *         is called as soon as the queue can proceed
+         */
+        using Gate = std::function< bool( std::function< void() > const & ) >;
+
+        struct Task
+        {
+            std::function< void() > work;
+            Gate gate;
+        };
+
+        //! priority of a queue without an explicit priority
+        static auto
+        leastPriority( )
+        -> int
+        {
+            return 0;
+        }
+
+        static auto
+        greatestPriority( )
+        -> int
+        {
+            return -2;
+        }
+
+        class TaskQueue
+        {
+        public:
+            TaskQueue( ) :
+                m_priority( leastPriority( ) )
+            { }
+
+            auto
+            empty( ) const
+            -> bool
+            {
+                std::lock_guard< std::mutex > lock( m_mutex );
+                return !m_scheduled;
+            }
+
+            auto
+            priority( ) const
+            -> int
+            {
+                return m_priority;
+            }
+
+            /** set the priority, clamped to the priority range of the pool
+             *
+             * Already scheduled work keeps its priority until the next task
+             * of the queue is executed.
+             */
+            void
+            setPriority( int const priority )
+            {
+                m_priority = std::min(
+                    std::max( priority, greatestPriority( ) ),
+                    leastPriority( )
+                );
+            }
+
+        private:
+            friend class WorkerPool;
+
+            std::atomic< int > m_priority;
+            mutable std::mutex m_mutex;
+            std::deque< Task > m_tasks;
+            /** queue is scheduled, parked at a gate or a worker executes a
+             *  task of the queue
+             */
+            bool m_scheduled = false;
+        };
+
+        using TaskQueuePtr = std::shared_ptr< TaskQueue >;
+
+        /** pool shared by all pooled streams
+         *
+         * The streams hold the pool, it is destroyed after the last stream.
+         */
+        static auto
+        get( )
+        -> std::shared_ptr< WorkerPool >
+        {
+            static std::shared_ptr< WorkerPool > pool( new WorkerPool( ) );
+            return pool;
+        }
+
+        WorkerPool( WorkerPool const & ) = delete;
+        WorkerPool & operator=( WorkerPool const & ) = delete;
+
+        //! finish all scheduled work and join the workers
+        ~WorkerPool( )
+        {
+            {
+                std::lock_guard< std::mutex > lock( m_mutex );
+                m_shutdown = true;
+            }
+            m_workAvailable.notify_all( );
+            for( auto & worker : m_workers )
+                worker.join( );
+        }
+
+        auto
+        createQueue( ) const
+        -> TaskQueuePtr
+        {
+            return std::make_shared< TaskQueue >( );
+        }
+
+        void
+        enqueue(
+            TaskQueuePtr const & queue,
+            Task task
+        )
+        {
+            bool schedule = false;
+            {
+                std::lock_guard< std::mutex > lock( queue->m_mutex );
+                queue->m_tasks.push_back( std::move( task ) );
+                if( !queue->m_scheduled )
+                {
+                    queue->m_scheduled = true;
+                    schedule = true;
+                }
+            }
+            if( schedule )
+                this->schedule( queue );
+        }
+
+        auto
+        numWorkers( ) const
+        -> std::size_t
+        {
+            return m_workers.size( );
+        }
+
+        /** number of workers the pool is created with
+         *
+         * Does not create the pool, other thread pools use it to share the
+         * cores with the stream workers.
+         */
+        static auto
+        configuredNumWorkers( )
+        -> std::size_t
+        {
+            char const * const threadsEnv = std::getenv(
+                "CUPLA_STREAM_POOL_THREADS"
+            );
+            if( threadsEnv != nullptr )
+                return std::max(
+                    static_cast< std::size_t >(
+                        std::strtoul( threadsEnv, nullptr, 10 )
+                    ),
+                    std::size_t( 1u )
+                );
+            return std::min(
+                std::max( std::thread::hardware_concurrency( ), 1u ),
+                4u
+            );
+        }
+
+    private:
+
+        WorkerPool( )
+        {
+            std::size_t const numThreads = configuredNumWorkers( );
+            m_workers.reserve( numThreads );
+            for( std::size_t i = 0u; i < numThreads; ++i )
+                m_workers.emplace_back( [ this ]( ){ this->work( ); } );
+        }
+
+        //! leastPriority() - greatestPriority() + 1
+        static constexpr std::size_t numPriorities = 3u;
+
+        void
+        schedule( TaskQueuePtr const & queue )
+        {
+            std::size_t const level = static_cast< std::size_t >(
+                queue->priority( ) - greatestPriority( )
+            );
+            {
+                std::lock_guard< std::mutex > lock( m_mutex );
+                m_ready[ level ].push_back( queue );
+                ++m_numReady;
+            }
+            m_workAvailable.notify_one( );
+        }
+
+        void
+        work( )
+        {
+            while( true )
+            {
+                TaskQueuePtr queue;
+                {
+                    std::unique_lock< std::mutex > lock( m_mutex );
+                    m_workAvailable.wait(
+                        lock,
+                        [ this ]( ){ return m_shutdown || m_numReady != 0u; }
+                    );
+                    if( m_numReady == 0u )
+                        return;
+                    // the first level holds the greatest priority
+                    for( auto & ready : m_ready )
+                        if( !ready.empty( ) )
+                        {
+                            queue = std::move( ready.front( ) );
+                            ready.pop_front( );
+                            break;
+                        }
+                    --m_numReady;
+                }
+                this->executeNext( queue );
+            }
+        }
+
+        //! execute the next task of a scheduled queue
+        void
+        executeNext( TaskQueuePtr const & queue )
+        {
+            Task task;
+            {
+                std::lock_guard< std::mutex > lock( queue->m_mutex );
+                task = std::move( queue->m_tasks.front( ) );
+                queue->m_tasks.pop_front( );
+            }
+
+            if( task.gate )
+            {
+                WorkerPool * const pool = this;
+                TaskQueuePtr const parked = queue;
+                // the gate must be passed again after the queue is resumed
+                Gate gate = task.gate;
+                {
+                    std::lock_guard< std::mutex > lock( queue->m_mutex );
+                    queue->m_tasks.push_front( std::move( task ) );
+                }
+                if( !gate( [ pool, parked ]( ){ pool->schedule( parked ); } ) )
+                    return;
+                std::lock_guard< std::mutex > lock( queue->m_mutex );
+                queue->m_tasks.pop_front( );
+            }
+            else
+                task.work( );
+
+            bool reschedule = false;
+            {
+                std::lock_guard< std::mutex > lock( queue->m_mutex );
+                if( queue->m_tasks.empty( ) )
+                    queue->m_scheduled = false;
+                else
+                    reschedule = true;
+            }
+            if( reschedule )
+                this->schedule( queue );
+        }
+
+        std::vector< std::thread > m_workers;
+        //! scheduled queues per priority level
+        std::deque< TaskQueuePtr > m_ready[ numPriorities ];
+        std::size_t m_numReady = 0u;
+        std::mutex m_mutex;
+        std::condition_variable m_workAvailable;
+        bool m_shutdown = false;
+    };
+
+} // namespace detail
+} // namespace stream
+} // namespace cupla
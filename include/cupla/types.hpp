@@ -66,6 +66,17 @@
     #error "there is no accelerator selected, please run `ccmake .` and select one"
 #endif
 
+/** if set to 1 the streams of CPU accelerators share a fixed pool of threads
+ * (cupla::stream::StreamCpuPool) instead of owning a thread each
+ */
+#ifndef CUPLA_STREAM_CPU_POOL
+#   define CUPLA_STREAM_CPU_POOL 1
+#endif
+
+#if( CUPLA_STREAM_CPU_POOL == 1 && ALPAKA_ACC_GPU_CUDA_ENABLED != 1 )
+#   include "cupla/stream/StreamCpuPool.hpp"
+#endif
+
 namespace cupla {
 
 
@@ -103,7 +114,11 @@ namespace cupla {
     defined(ALPAKA_ACC_CPU_B_SEQ_T_SEQ_ENABLED)
 
     using AccDev = ::alpaka::dev::DevCpu;
+#if( CUPLA_STREAM_CPU_POOL == 1 )
+    using AccStream = ::cupla::stream::StreamCpuPool;
+#else
     using AccStream = ::alpaka::stream::StreamCpuAsync;
+#endif
 
 #ifdef ALPAKA_ACC_CPU_B_SEQ_T_OMP2_ENABLED
     using Acc = ::alpaka::acc::AccCpuOmp2Threads<
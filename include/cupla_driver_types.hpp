@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include <cstddef>
+
 // emulated that cuda runtime is loaded
 #ifndef __DRIVER_TYPES_H__
 # define __DRIVER_TYPES_H__
@@ -32,7 +34,11 @@ enum cuplaMemcpyKind
   cuplaMemcpyHostToHost,
   cuplaMemcpyHostToDevice,
   cuplaMemcpyDeviceToHost,
-  cuplaMemcpyDeviceToDevice
+  cuplaMemcpyDeviceToDevice,
+  /** direction is derived from the pointers, memory not allocated by cupla
+   * is handled as host memory
+   */
+  cuplaMemcpyDefault
 };
 
 enum cuplaError
@@ -40,7 +46,26 @@ enum cuplaError
     cuplaSuccess = 0,
     cuplaErrorMemoryAllocation = 2,
     cuplaErrorInitializationError = 3,
-    cuplaErrorNotReady = 34
+    cuplaErrorInvalidValue = 11,
+    cuplaErrorInvalidDevicePointer = 17,
+    cuplaErrorInvalidResourceHandle = 33,
+    cuplaErrorNotReady = 34,
+    cuplaErrorHostMemoryAlreadyRegistered = 61,
+    cuplaErrorHostMemoryNotRegistered = 62
+};
+
+enum cuplaMemoryType
+{
+    cuplaMemoryTypeUnregistered = 0,
+    cuplaMemoryTypeHost = 1,
+    cuplaMemoryTypeDevice = 2
+};
+
+enum StreamProp
+{
+    cuplaStreamDefault = 0,
+    //! the stream does not synchronize with the default stream
+    cuplaStreamNonBlocking = 1
 };
 
 enum EventProp
@@ -48,10 +73,124 @@ enum EventProp
     cuplaEventDisableTiming = 2
 };
 
+enum HostAllocProp
+{
+    cuplaHostAllocDefault = 0,
+    cuplaHostAllocPortable = 1,
+    cuplaHostAllocMapped = 2,
+    cuplaHostAllocWriteCombined = 4
+};
+
+/** flags of cuplaMallocWithFlags
+ *
+ * The flags use other bits than HostAllocProp and can be combined with them
+ * in cuplaHostAlloc.
+ */
+enum cuplaMallocFlags
+{
+    cuplaMallocDefault = 0,
+    //! back the allocation with huge pages independent of its size
+    cuplaMallocHugePages = 0x10,
+    //! never back the allocation with huge pages
+    cuplaMallocNoHugePages = 0x20,
+    //! interleave the pages over all NUMA nodes
+    cuplaMallocNumaInterleave = 0x40,
+    //! place the pages on the NUMA node of the allocating thread
+    cuplaMallocNumaLocal = 0x80,
+    //! place the pages by touching them with the block distribution of a kernel
+    cuplaMallocNumaFirstTouch = 0x100,
+    //! zero fill the memory, see cuplaMallocZeroed()
+    cuplaMallocZeroInitialized = 0x200
+};
+
+enum cuplaHugePageType
+{
+    cuplaHugePageNone = 0,
+    //! transparent huge pages requested with madvise
+    cuplaHugePageTransparent = 1,
+    //! explicit huge pages (MAP_HUGETLB)
+    cuplaHugePageExplicit = 2
+};
+
+enum cuplaNumaPlacement
+{
+    //! pages are placed by the thread touching them first
+    cuplaNumaPlacementDefault = 0,
+    cuplaNumaPlacementInterleave = 1,
+    cuplaNumaPlacementLocal = 2,
+    cuplaNumaPlacementFirstTouch = 3
+};
+
+enum HostRegisterProp
+{
+    cuplaHostRegisterDefault = 0,
+    cuplaHostRegisterPortable = 1,
+    cuplaHostRegisterMapped = 2,
+    cuplaHostRegisterIoMemory = 4,
+    cuplaHostRegisterReadOnly = 8
+};
+
 using cuplaError_t = enum cuplaError;
 
 
 using cuplaStream_t = void*;
 
+/** stream of the calling host thread
+ *
+ * The stream is created with the first use on a device and synchronizes with
+ * the default stream 0 like a stream created by the thread.
+ */
+#define cuplaStreamPerThread ( ( cuplaStream_t ) 0x2 )
+
 using cuplaEvent_t = void*;
 
+/** properties of memory allocated with cupla
+ *
+ * `basePointer`, `size`, `dimension` and `pitch` are cupla extensions and
+ * describe the whole allocation a pointer belongs to.
+ */
+struct cuplaPointerAttributes
+{
+    enum cuplaMemoryType type;
+    int device;
+    void * devicePointer;
+    void * hostPointer;
+    void * basePointer;
+    size_t size;
+    unsigned int dimension;
+    size_t pitch;
+    /** flags used to allocate the memory, cuplaHostRegister flags if
+     *  `registered` is set
+     */
+    unsigned int flags;
+    //! 1 if the memory was registered with cuplaHostRegister, else 0
+    int registered;
+    //! huge pages backing the allocation
+    enum cuplaHugePageType hugePages;
+    //! NUMA placement applied to the allocation
+    enum cuplaNumaPlacement numaPlacement;
+};
+
+/** statistics of the memory pool of a device
+ *
+ * All byte counts include the rounding of the allocation to its size class.
+ */
+struct cuplaMemPoolStats
+{
+    //! bytes of allocations in use
+    size_t liveBytes;
+    //! bytes of freed allocations kept for reuse
+    size_t cachedBytes;
+    //! maximum of liveBytes
+    size_t peakLiveBytes;
+    //! maximum of liveBytes + cachedBytes
+    size_t highWaterBytes;
+    //! maximal number of cached bytes
+    size_t cacheLimit;
+    //! maximal number of live and cached bytes
+    size_t capacity;
+    size_t numAllocations;
+    //! allocations served from the cache
+    size_t numCacheHits;
+    size_t numFrees;
+};
@@ -26,6 +26,7 @@
 #include "cupla/manager/Stream.hpp"
 #include "cupla/manager/Event.hpp"
 #include "cupla/api/common.hpp"
+#include "cupla/detail/LastError.hpp"
 
 
 const char *
@@ -37,5 +38,7 @@ cuplaGetErrorString(cuplaError_t)
 cuplaError_t
 cuplaGetLastError()
 {
-    return cuplaSuccess;
+    cuplaError_t const error = cupla::detail::lastError();
+    cupla::detail::lastError() = cuplaSuccess;
+    return error;
 }
@@ -22,11 +22,14 @@
 
 #include "cupla_runtime.hpp"
 #include "cupla/manager/Memory.hpp"
+#include "cupla/manager/AllocationTracer.hpp"
 #include "cupla/manager/Device.hpp"
 #include "cupla/manager/Stream.hpp"
 #include "cupla/manager/Event.hpp"
 #include "cupla/api/device.hpp"
 
+#include <algorithm>
+
 cuplaError_t
 cuplaGetDeviceCount( int * count)
 {
@@ -60,6 +63,11 @@ cuplaDeviceReset( )
         cupla::AccStream 
     >::get().reset( );
     
+    // write the allocation trace including the memory still in use
+    auto& tracer = cupla::manager::AllocationTracer::get( );
+    if( tracer.isEnabled( ) )
+        tracer.dump( );
+
     // delete all memory on the current device
     cupla::manager::Memory<
         cupla::AccDev,
@@ -75,6 +83,12 @@ cuplaDeviceReset( )
         cupla::AccDev,
         cupla::AlpakaDim<3u>
     >::get().reset( );
+
+    cupla::manager::Memory<
+        cupla::AccHost,
+        cupla::AlpakaDim<1u>,
+        cuplaMemoryTypeHost
+    >::get().reset( );
     
     // delete all streams on the current device
     cupla::manager::Stream< 
@@ -89,12 +103,36 @@ cuplaDeviceReset( )
 cuplaError_t
 cuplaDeviceSynchronize( )
 {   
+    // streams which are not owned by a thread of the alpaka device
+    cupla::manager::Stream<
+        cupla::AccDev,
+        cupla::AccStream
+    >::get().synchronize( );
+
     ::alpaka::wait::wait(
         cupla::manager::Device< cupla::AccDev >::get( ).current( )
     );
     return cuplaSuccess;
 }
 
+cuplaError_t
+cuplaDeviceGetStreamPriorityRange(
+    int * leastPriority,
+    int * greatestPriority
+)
+{
+    using Priority = cupla::manager::Stream<
+        cupla::AccDev,
+        cupla::AccStream
+    >::Priority;
+
+    if( leastPriority != nullptr )
+        *leastPriority = Priority::least( );
+    if( greatestPriority != nullptr )
+        *greatestPriority = Priority::greatest( );
+    return cuplaSuccess;
+}
+
 cuplaError_t
 cuplaMemGetInfo(
     size_t * free,
@@ -108,5 +146,22 @@ cuplaMemGetInfo(
     );
     *total = ::alpaka::dev::getMemBytes( device );
     *free = ::alpaka::dev::getFreeMemBytes( device );
+
+    // report against the capacity set for cupla
+    auto const stats = cupla::manager::detail::MemoryCacheBudget<
+        cupla::AccDev,
+        cuplaMemoryTypeDevice
+    >::get().stats(
+        cupla::manager::Device<
+            cupla::AccDev
+        >::get().id()
+    );
+    if( stats.capacity < *total )
+    {
+        size_t const capacityFree = stats.liveBytes < stats.capacity ?
+            stats.capacity - stats.liveBytes : 0u;
+        *total = stats.capacity;
+        *free = std::min( *free, capacityFree );
+    }
     return cuplaSuccess;
 }
@@ -75,16 +75,18 @@ cuplaEventRecord(
     cuplaStream_t stream
 )
 {
-    auto& streamObject = cupla::manager::Stream<
+    auto * const streamObject = cupla::manager::Stream<
         cupla::AccDev,
         cupla::AccStream
     >::get().stream( stream );
-    auto& eventObject = cupla::manager::Event<
+    auto * const eventObject = cupla::manager::Event<
         cupla::AccDev,
         cupla::AccStream
     >::get().event( event );
+    if( streamObject == nullptr || eventObject == nullptr )
+        return cuplaErrorInvalidResourceHandle;
 
-    eventObject.record( streamObject );
+    eventObject->record( *streamObject );
     return cuplaSuccess;
 }
 
@@ -95,15 +97,17 @@ cuplaEventElapsedTime(
     cuplaEvent_t end
 )
 {
-    auto& eventStart = cupla::manager::Event<
+    auto * const eventStart = cupla::manager::Event<
         cupla::AccDev,
         cupla::AccStream
     >::get().event( start );
-    auto& eventEnd = cupla::manager::Event<
+    auto * const eventEnd = cupla::manager::Event<
         cupla::AccDev,
         cupla::AccStream
     >::get().event( end );
-    *ms = eventEnd.elapsedSince(eventStart);
+    if( eventStart == nullptr || eventEnd == nullptr )
+        return cuplaErrorInvalidResourceHandle;
+    *ms = eventEnd->elapsedSince( *eventStart );
     return cuplaSuccess;
 }
 
@@ -112,23 +116,27 @@ cuplaEventSynchronize(
     cuplaEvent_t event
 )
 {
-    auto& eventObject = cupla::manager::Event<
+    auto * const eventObject = cupla::manager::Event<
         cupla::AccDev,
         cupla::AccStream
     >::get().event( event );
-    ::alpaka::wait::wait( *eventObject );
+    if( eventObject == nullptr )
+        return cuplaErrorInvalidResourceHandle;
+    ::alpaka::wait::wait( **eventObject );
     return cuplaSuccess;
 }
 
 cuplaError_t
 cuplaEventQuery( cuplaEvent_t event )
 {
-    auto& eventObject = cupla::manager::Event<
+    auto * const eventObject = cupla::manager::Event<
         cupla::AccDev,
         cupla::AccStream
     >::get().event( event );
+    if( eventObject == nullptr )
+        return cuplaErrorInvalidResourceHandle;
 
-    if( ::alpaka::event::test( *eventObject ) )
+    if( ::alpaka::event::test( **eventObject ) )
     {
         return cuplaSuccess;
     }
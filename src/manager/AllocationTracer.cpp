@@ -0,0 +1,284 @@
+/**
+ * Copyright 2016 Rene Widera
+ *
+ * This file is part of cupla.
+ *
+ * cupla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cupla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cupla.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "cupla/manager/AllocationTracer.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+
+namespace cupla
+{
+namespace manager
+{
+
+namespace
+{
+    //! interned tag of the calling thread
+    thread_local char const * currentTag = nullptr;
+
+    char const *
+    memoryTypeName( cuplaMemoryType const type )
+    {
+        switch( type )
+        {
+            case cuplaMemoryTypeHost:
+                return "host";
+            case cuplaMemoryTypeDevice:
+                return "device";
+            default:
+                return "unregistered";
+        }
+    }
+
+    //! write a string as JSON string literal
+    void
+    writeString(
+        std::ostream & out,
+        char const * str
+    )
+    {
+        out << '"';
+        for( ; str != nullptr && *str != '\0'; ++str )
+        {
+            if( *str == '"' || *str == '\\' )
+                out << '\\' << *str;
+            else if( static_cast< unsigned char >( *str ) < 0x20u )
+                out << ' ';
+            else
+                out << *str;
+        }
+        out << '"';
+    }
+
+} // namespace
+
+AllocationTracer::AllocationTracer( ) :
+    m_enabled( false ),
+    m_numDumps( 0u ),
+    m_start( std::chrono::steady_clock::now( ) ),
+    m_numEvents( 0u ),
+    m_liveBytes( 0u ),
+    m_peakBytes( 0u ),
+    m_peakTime( 0u ),
+    m_isPeakLive( false )
+{
+    char const * const fileName = std::getenv( "CUPLA_ALLOC_TRACE" );
+    if( fileName == nullptr || *fileName == '\0' )
+        return;
+
+    std::size_t size = 65536u;
+    char const * const sizeEnv = std::getenv( "CUPLA_ALLOC_TRACE_SIZE" );
+    if( sizeEnv != nullptr )
+        size = std::strtoull( sizeEnv, nullptr, 10 );
+
+    m_fileName = fileName;
+    m_events.resize( size );
+    m_enabled = size != 0u;
+}
+
+AllocationTracer::~AllocationTracer( )
+{
+    if( m_enabled )
+        this->dump( );
+}
+
+uint64_t
+AllocationTracer::now( ) const
+{
+    return static_cast< uint64_t >(
+        std::chrono::duration_cast< std::chrono::nanoseconds >(
+            std::chrono::steady_clock::now( ) - m_start
+        ).count( )
+    );
+}
+
+void
+AllocationTracer::setTag( char const * const tag )
+{
+    if( tag == nullptr )
+    {
+        currentTag = nullptr;
+        return;
+    }
+
+    std::lock_guard< std::mutex > lock( m_mutex );
+    currentTag = m_tags.insert( tag ).first->c_str( );
+}
+
+void
+AllocationTracer::push( Event const & event )
+{
+    m_events[ m_numEvents % m_events.size( ) ] = event;
+    ++m_numEvents;
+}
+
+void
+AllocationTracer::recordAlloc(
+    void const * const ptr,
+    MemSizeType const bytes,
+    uint32_t const dim,
+    int const device,
+    cuplaMemoryType const type,
+    cuplaStream_t const stream
+)
+{
+    if( !m_enabled )
+        return;
+
+    Event const event{
+        this->now( ),
+        ptr,
+        bytes,
+        stream,
+        currentTag,
+        device,
+        dim,
+        type,
+        true
+    };
+
+    std::lock_guard< std::mutex > lock( m_mutex );
+    this->push( event );
+
+    m_live[ ptr ] = Live{ bytes, event.tag, device, dim, type };
+    auto& site = m_liveSites[ event.tag ];
+    site.bytes += bytes;
+    ++site.count;
+    m_liveBytes += bytes;
+
+    if( m_liveBytes > m_peakBytes )
+    {
+        m_peakBytes = m_liveBytes;
+        m_peakTime = event.time;
+        m_isPeakLive = true;
+    }
+}
+
+void
+AllocationTracer::recordFree(
+    void const * const ptr,
+    cuplaStream_t const stream
+)
+{
+    if( !m_enabled )
+        return;
+
+    uint64_t const time = this->now( );
+
+    std::lock_guard< std::mutex > lock( m_mutex );
+    auto const live = m_live.find( ptr );
+    if( live == m_live.end( ) )
+        return;
+
+    Event const event{
+        time,
+        ptr,
+        live->second.bytes,
+        stream,
+        live->second.tag,
+        live->second.device,
+        live->second.dim,
+        live->second.type,
+        false
+    };
+    this->push( event );
+
+    // the first release after a new peak changes the live sites
+    if( m_isPeakLive )
+    {
+        m_peakSites = m_liveSites;
+        m_isPeakLive = false;
+    }
+
+    auto site = m_liveSites.find( event.tag );
+    site->second.bytes -= event.bytes;
+    if( --site->second.count == 0u )
+        m_liveSites.erase( site );
+    m_liveBytes -= event.bytes;
+    m_live.erase( live );
+}
+
+bool
+AllocationTracer::dump( char const * const fileName )
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+
+    std::string outName;
+    if( fileName != nullptr )
+        outName = fileName;
+    else
+    {
+        // a later dump must not overwrite the dump of a device reset
+        outName = m_fileName;
+        if( m_numDumps != 0u )
+            outName += "." + std::to_string( m_numDumps );
+        ++m_numDumps;
+    }
+
+    std::ofstream out( outName.c_str( ) );
+    if( !out )
+        return false;
+
+    uint64_t const numStored = std::min< uint64_t >(
+        m_numEvents,
+        m_events.size( )
+    );
+
+    out << "{\n\"dropped\": " << m_numEvents - numStored << ",\n";
+    out << "\"events\": [\n";
+    for( uint64_t i = m_numEvents - numStored; i < m_numEvents; ++i )
+    {
+        Event const & event = m_events[ i % m_events.size( ) ];
+        out << "{\"t\": " << event.time
+            << ", \"op\": \"" << ( event.isAlloc ? "alloc" : "free" )
+            << "\", \"ptr\": \"" << event.ptr
+            << "\", \"bytes\": " << event.bytes
+            << ", \"stream\": \"" << event.stream
+            << "\", \"dim\": " << event.dim
+            << ", \"device\": " << event.device
+            << ", \"type\": \"" << memoryTypeName( event.type ) << "\"";
+        out << ", \"tag\": ";
+        writeString( out, event.tag );
+        out << ( i + 1u < m_numEvents ? "},\n" : "}\n" );
+    }
+    out << "],\n";
+
+    SiteMap const & peakSites = m_isPeakLive ? m_liveSites : m_peakSites;
+    out << "\"peak\": {\"bytes\": " << m_peakBytes
+        << ", \"t\": " << m_peakTime << ", \"sites\": [\n";
+    for( auto iter = peakSites.begin( ); iter != peakSites.end( ); )
+    {
+        out << "{\"tag\": ";
+        writeString( out, iter->first );
+        out << ", \"bytes\": " << iter->second.bytes
+            << ", \"count\": " << iter->second.count;
+        out << ( ++iter != peakSites.end( ) ? "},\n" : "}\n" );
+    }
+    out << "]},\n";
+    out << "\"live\": {\"bytes\": " << m_liveBytes << "}\n}\n";
+
+    return static_cast< bool >( out );
+}
+
+} //namespace manager
+} //namespace cupla
@@ -0,0 +1,754 @@
+/**
+ * Copyright 2016 Rene Widera
+ *
+ * This file is part of cupla.
+ *
+ * cupla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cupla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with cupla.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cupla/manager/CopyEngine.hpp"
+#include "cupla/detail/CopyPlan.hpp"
+// CUPLA_STREAM_CPU_POOL is enabled by default (see cupla/types.hpp)
+#if !defined(CUPLA_STREAM_CPU_POOL) || ( CUPLA_STREAM_CPU_POOL == 1 )
+#   include "cupla/stream/WorkerPool.hpp"
+#endif
+
+#include <algorithm>
+#include <limits>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__SSE2__)
+#   include <emmintrin.h>
+#endif
+
+#if defined(__linux__)
+#   include <pthread.h>
+#   include <sched.h>
+#endif
+
+namespace cupla
+{
+namespace manager
+{
+
+namespace
+{
+    constexpr std::size_t pageSize = 4096u;
+
+    std::size_t
+    envOrDefault(
+        char const * const name,
+        std::size_t const defaultValue
+    )
+    {
+        char const * const value = std::getenv( name );
+        if( value == nullptr )
+            return defaultValue;
+        return static_cast< std::size_t >( std::strtoull( value, nullptr, 10 ) );
+    }
+
+    /** copy with streaming stores which bypass the cache */
+    void
+    copyNonTemporal(
+        uint8_t * dst,
+        uint8_t const * src,
+        std::size_t bytes
+    )
+    {
+#if defined(__SSE2__)
+        constexpr std::size_t vecBytes = sizeof( __m128i );
+        std::size_t const head = std::min(
+            bytes,
+            ( vecBytes - reinterpret_cast< std::uintptr_t >( dst ) % vecBytes ) % vecBytes
+        );
+        std::memcpy( dst, src, head );
+        dst += head;
+        src += head;
+        bytes -= head;
+
+        std::size_t const body = bytes / ( 4u * vecBytes ) * ( 4u * vecBytes );
+        for( std::size_t i = 0u; i < body; i += 4u * vecBytes )
+        {
+            __m128i const * const s = reinterpret_cast< __m128i const * >( src + i );
+            __m128i * const d = reinterpret_cast< __m128i * >( dst + i );
+            __m128i const v0 = _mm_loadu_si128( s );
+            __m128i const v1 = _mm_loadu_si128( s + 1 );
+            __m128i const v2 = _mm_loadu_si128( s + 2 );
+            __m128i const v3 = _mm_loadu_si128( s + 3 );
+            _mm_stream_si128( d, v0 );
+            _mm_stream_si128( d + 1, v1 );
+            _mm_stream_si128( d + 2, v2 );
+            _mm_stream_si128( d + 3, v3 );
+        }
+        _mm_sfence( );
+        std::memcpy( dst + body, src + body, bytes - body );
+#else
+        std::memcpy( dst, src, bytes );
+#endif
+    }
+
+    /** repeat the lowest `elemSize` bytes of value to an 8 byte pattern
+     *
+     * @param elemSize 1, 2, 4 or 8
+     */
+    uint64_t
+    broadcastPattern(
+        uint64_t const value,
+        std::size_t const elemSize
+    )
+    {
+        uint64_t pattern = elemSize >= 8u ? value :
+            value & ( ( uint64_t( 1u ) << ( elemSize * 8u ) ) - 1u );
+        for( std::size_t size = elemSize; size < 8u; size *= 2u )
+            pattern |= pattern << ( size * 8u );
+        return pattern;
+    }
+
+    /** rotate an 8 byte pattern to start `offset` bytes later
+     *
+     * The byte order in memory is assumed to be little endian.
+     */
+    uint64_t
+    rotatePattern(
+        uint64_t const pattern,
+        std::size_t const offset
+    )
+    {
+        unsigned const shift = static_cast< unsigned >( offset % 8u ) * 8u;
+        return shift == 0u ? pattern :
+            ( pattern >> shift ) | ( pattern << ( 64u - shift ) );
+    }
+
+    /** fill memory with a repeated 8 byte pattern
+     *
+     * The body is written with aligned 16 byte broadcast stores, streaming
+     * stores are used to bypass the cache if `nonTemporal` is set.
+     */
+    void
+    fillPattern(
+        uint8_t * dst,
+        uint64_t pattern,
+        std::size_t bytes,
+        bool const nonTemporal
+    )
+    {
+        uint8_t const firstByte = static_cast< uint8_t >( pattern );
+        bool const isBytePattern =
+            pattern == firstByte * uint64_t( 0x0101010101010101u );
+        if( isBytePattern && !nonTemporal )
+        {
+            std::memset( dst, firstByte, bytes );
+            return;
+        }
+
+        uint8_t patternBytes[ 8 ];
+        std::memcpy( patternBytes, &pattern, 8u );
+
+#if defined(__SSE2__)
+        constexpr std::size_t vecBytes = sizeof( __m128i );
+        std::size_t const head = std::min(
+            bytes,
+            ( vecBytes - reinterpret_cast< std::uintptr_t >( dst ) % vecBytes ) % vecBytes
+        );
+        for( std::size_t i = 0u; i < head; ++i )
+            dst[ i ] = patternBytes[ i % 8u ];
+        dst += head;
+        bytes -= head;
+        pattern = rotatePattern( pattern, head );
+        std::memcpy( patternBytes, &pattern, 8u );
+
+        __m128i const v = _mm_set1_epi64x( static_cast< long long >( pattern ) );
+        std::size_t const body = bytes / ( 4u * vecBytes ) * ( 4u * vecBytes );
+        if( nonTemporal )
+        {
+            for( std::size_t i = 0u; i < body; i += 4u * vecBytes )
+            {
+                __m128i * const d = reinterpret_cast< __m128i * >( dst + i );
+                _mm_stream_si128( d, v );
+                _mm_stream_si128( d + 1, v );
+                _mm_stream_si128( d + 2, v );
+                _mm_stream_si128( d + 3, v );
+            }
+            _mm_sfence( );
+        }
+        else
+        {
+            for( std::size_t i = 0u; i < body; i += 4u * vecBytes )
+            {
+                __m128i * const d = reinterpret_cast< __m128i * >( dst + i );
+                _mm_store_si128( d, v );
+                _mm_store_si128( d + 1, v );
+                _mm_store_si128( d + 2, v );
+                _mm_store_si128( d + 3, v );
+            }
+        }
+        // the body is a multiple of 8 byte, the pattern phase is unchanged
+        for( std::size_t i = body; i < bytes; ++i )
+            dst[ i ] = patternBytes[ i % 8u ];
+#else
+        std::size_t const body = bytes / 8u * 8u;
+        for( std::size_t i = 0u; i < body; i += 8u )
+            std::memcpy( dst + i, patternBytes, 8u );
+        for( std::size_t i = body; i < bytes; ++i )
+            dst[ i ] = patternBytes[ i % 8u ];
+#endif
+    }
+} // namespace
+
+struct CopyEngine::Job
+{
+    std::function< void( std::size_t ) > const & m_func;
+    std::size_t const m_size;
+    std::atomic< std::size_t > m_next;
+    std::atomic< std::size_t > m_finished;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+
+    Job(
+        std::function< void( std::size_t ) > const & func,
+        std::size_t const size
+    ) :
+        m_func( func ),
+        m_size( size ),
+        m_next( 0u ),
+        m_finished( 0u )
+    { }
+
+    bool
+    isStarted( ) const
+    {
+        return m_next.load() >= m_size;
+    }
+
+    //! execute indices until all are taken
+    void
+    run( )
+    {
+        std::size_t idx;
+        while( ( idx = m_next++ ) < m_size )
+        {
+            m_func( idx );
+            if( ++m_finished == m_size )
+            {
+                std::lock_guard< std::mutex > lock( m_mutex );
+                m_condition.notify_all( );
+            }
+        }
+    }
+
+    void
+    wait( )
+    {
+        std::unique_lock< std::mutex > lock( m_mutex );
+        m_condition.wait(
+            lock,
+            [ this ]{ return m_finished.load() == m_size; }
+        );
+    }
+};
+
+CopyEngine::CopyEngine( ) :
+    m_numThreads( 1u ),
+    m_numWorkers( 0u ),
+    m_started( false ),
+    m_stop( false ),
+    m_bindThreads( envOrDefault( "CUPLA_MEMCPY_BIND", 0u ) != 0u ),
+    m_chunkSize( 1024u * 1024u ),
+    m_nonTemporalThreshold(
+        envOrDefault( "CUPLA_MEMCPY_NT_THRESHOLD", 16u * 1024u * 1024u )
+    )
+{
+    this->setChunkSize( envOrDefault( "CUPLA_MEMCPY_CHUNK_SIZE", m_chunkSize ) );
+
+    std::size_t const numCores = std::max(
+        std::thread::hardware_concurrency( ),
+        1u
+    );
+    /* the stream worker issuing a copy takes part in it, only the cores not
+     * used by the other stream workers are left for the copy workers
+     */
+    std::size_t numStreamWorkers = 1u;
+#if !defined(CUPLA_STREAM_CPU_POOL) || ( CUPLA_STREAM_CPU_POOL == 1 )
+    numStreamWorkers = cupla::stream::detail::WorkerPool::configuredNumWorkers( );
+#endif
+    std::size_t const freeCores = numCores > numStreamWorkers ?
+        numCores - numStreamWorkers : 0u;
+    this->setNumThreads(
+        envOrDefault(
+            "CUPLA_MEMCPY_THREADS",
+            std::min( freeCores + 1u, static_cast< std::size_t >( 8u ) )
+        )
+    );
+}
+
+CopyEngine::~CopyEngine( )
+{
+    this->stopWorkers( );
+}
+
+void
+CopyEngine::setNumThreads( std::size_t const numThreads )
+{
+    this->stopWorkers( );
+    m_numThreads = std::max( numThreads, static_cast< std::size_t >( 1u ) );
+}
+
+void
+CopyEngine::setChunkSize( std::size_t const chunkSize )
+{
+    // chunks are page aligned, a smaller chunk breaks the head alignment
+    if( chunkSize == 0u )
+        return;
+    std::size_t const maxChunkSize =
+        std::numeric_limits< std::size_t >::max( ) / pageSize * pageSize;
+    m_chunkSize = chunkSize > maxChunkSize ?
+        maxChunkSize :
+        ( chunkSize + pageSize - 1u ) / pageSize * pageSize;
+}
+
+void
+CopyEngine::setNonTemporalThreshold( std::size_t const bytes )
+{
+    m_nonTemporalThreshold = bytes;
+}
+
+void
+CopyEngine::startWorkers( )
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+    if( m_started.load( ) )
+        return;
+    m_stop = false;
+    m_numWorkers = m_numThreads - 1u;
+    for( std::size_t i = 0u; i < m_numWorkers; ++i )
+        m_workers.emplace_back( &CopyEngine::work, this, i );
+    m_started.store( true );
+}
+
+void
+CopyEngine::stopWorkers( )
+{
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+        m_stop = true;
+    }
+    m_condition.notify_all( );
+    for( auto & worker : m_workers )
+        worker.join( );
+    m_workers.clear( );
+    m_numWorkers = 0u;
+    m_started.store( false );
+}
+
+void
+CopyEngine::work( std::size_t const workerIdx )
+{
+#if defined(__linux__)
+    if( m_bindThreads )
+    {
+        /* spread the workers over all cores the process can use, the
+         * calling thread is counted as first worker
+         */
+        cpu_set_t available;
+        CPU_ZERO( &available );
+        if( sched_getaffinity( 0, sizeof( available ), &available ) == 0 )
+        {
+            std::vector< int > cores;
+            for( int c = 0; c < CPU_SETSIZE; ++c )
+                if( CPU_ISSET( c, &available ) )
+                    cores.push_back( c );
+
+            std::size_t const numThreads = m_numWorkers + 1u;
+            cpu_set_t target;
+            CPU_ZERO( &target );
+            CPU_SET(
+                cores[ ( workerIdx + 1u ) * cores.size( ) / numThreads ],
+                &target
+            );
+            pthread_setaffinity_np( pthread_self( ), sizeof( target ), &target );
+        }
+    }
+#endif
+
+    std::unique_lock< std::mutex > lock( m_mutex );
+    while( true )
+    {
+        m_condition.wait(
+            lock,
+            [ this ]{ return m_stop || !m_jobs.empty( ); }
+        );
+        if( m_stop )
+            return;
+
+        std::shared_ptr< Job > job = m_jobs.front( );
+        if( job->isStarted( ) )
+        {
+            m_jobs.pop_front( );
+            continue;
+        }
+        lock.unlock( );
+        job->run( );
+        lock.lock( );
+    }
+}
+
+void
+CopyEngine::parallelFor(
+    std::size_t const size,
+    std::function< void( std::size_t ) > const & func
+)
+{
+    if( m_numThreads == 1u || size <= 1u )
+    {
+        for( std::size_t i = 0u; i < size; ++i )
+            func( i );
+        return;
+    }
+
+    if( !m_started.load( ) )
+        this->startWorkers( );
+
+    auto job = std::make_shared< Job >( func, size );
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+        m_jobs.push_back( job );
+    }
+    m_condition.notify_all( );
+
+    job->run( );
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+        auto iter = std::find( m_jobs.begin( ), m_jobs.end( ), job );
+        if( iter != m_jobs.end( ) )
+            m_jobs.erase( iter );
+    }
+    job->wait( );
+}
+
+void
+CopyEngine::copyChunk(
+    uint8_t * const dst,
+    uint8_t const * const src,
+    std::size_t const bytes,
+    bool const nonTemporal
+) const
+{
+    if( nonTemporal )
+        copyNonTemporal( dst, src, bytes );
+    else
+        std::memcpy( dst, src, bytes );
+}
+
+void
+CopyEngine::setChunk(
+    uint8_t * const dst,
+    uint64_t const pattern,
+    std::size_t const bytes,
+    bool const nonTemporal
+) const
+{
+    fillPattern( dst, pattern, bytes, nonTemporal );
+}
+
+void
+CopyEngine::copy(
+    void * const dst,
+    void const * const src,
+    std::size_t const bytes
+)
+{
+    auto const dstPtr = static_cast< uint8_t * >( dst );
+    auto const srcPtr = static_cast< uint8_t const * >( src );
+    bool const nonTemporal = bytes >= m_nonTemporalThreshold;
+
+    std::size_t const numChunks = std::min(
+        this->getNumThreads( ),
+        bytes / m_chunkSize
+    );
+
+    if( numChunks <= 1u )
+    {
+        this->copyChunk( dstPtr, srcPtr, bytes, nonTemporal );
+        return;
+    }
+
+    /* chunk borders are aligned to the pages of the destination, the first
+     * chunk additionally contains the bytes up to the first page border
+     */
+    std::size_t const head = (
+        pageSize - reinterpret_cast< std::uintptr_t >( dstPtr ) % pageSize
+    ) % pageSize;
+    std::size_t chunkBytes = ( bytes - head + numChunks - 1u ) / numChunks;
+    chunkBytes = ( chunkBytes + pageSize - 1u ) / pageSize * pageSize;
+    std::size_t const size = ( bytes - head + chunkBytes - 1u ) / chunkBytes;
+
+    this->parallelFor(
+        size,
+        [ & ]( std::size_t const i )
+        {
+            std::size_t const begin = i == 0u ? 0u : head + i * chunkBytes;
+            std::size_t const end = std::min( bytes, head + ( i + 1u ) * chunkBytes );
+            this->copyChunk(
+                dstPtr + begin,
+                srcPtr + begin,
+                end - begin,
+                nonTemporal
+            );
+        }
+    );
+}
+
+void
+CopyEngine::copy3D(
+    void * const dst,
+    std::size_t const dstPitch,
+    std::size_t const dstSlicePitch,
+    void const * const src,
+    std::size_t const srcPitch,
+    std::size_t const srcSlicePitch,
+    std::size_t const width,
+    std::size_t const height,
+    std::size_t const depth
+)
+{
+    detail::CopyPlan const plan(
+        width,
+        height,
+        depth,
+        dstPitch,
+        dstSlicePitch,
+        srcPitch,
+        srcSlicePitch
+    );
+
+    if( plan.bytes( ) == 0u )
+        return;
+
+    if( plan.isContiguous( ) )
+    {
+        this->copy( dst, src, plan.bytes( ) );
+        return;
+    }
+
+    auto const dstPtr = static_cast< uint8_t * >( dst );
+    auto const srcPtr = static_cast< uint8_t const * >( src );
+    std::size_t const rowBytes = plan.m_extent[ 0 ];
+    std::size_t const numRows = plan.numRows( );
+
+    // rows which are large enough are split over all threads one by one
+    if( rowBytes >= m_chunkSize * this->getNumThreads( ) )
+    {
+        for( std::size_t row = 0u; row < numRows; ++row )
+            this->copy(
+                dstPtr + plan.dstOffset( row ),
+                srcPtr + plan.srcOffset( row ),
+                rowBytes
+            );
+        return;
+    }
+
+    // else each thread copies a block of rows with at least one chunk size
+    bool const nonTemporal = plan.bytes( ) >= m_nonTemporalThreshold;
+    std::size_t const rowsPerTask = std::max(
+        ( m_chunkSize + rowBytes - 1u ) / rowBytes,
+        std::size_t( 1u )
+    );
+    std::size_t const numTasks = ( numRows + rowsPerTask - 1u ) / rowsPerTask;
+
+    auto const copyRows = [ & ]( std::size_t const task )
+    {
+        std::size_t const end = std::min( numRows, ( task + 1u ) * rowsPerTask );
+        for( std::size_t row = task * rowsPerTask; row < end; ++row )
+            this->copyChunk(
+                dstPtr + plan.dstOffset( row ),
+                srcPtr + plan.srcOffset( row ),
+                rowBytes,
+                nonTemporal
+            );
+    };
+
+    if( numTasks == 1u )
+        copyRows( 0u );
+    else
+        this->parallelFor( numTasks, copyRows );
+}
+
+void
+CopyEngine::copyBatch(
+    void * const * const dsts,
+    void const * const * const srcs,
+    std::size_t const * const sizes,
+    std::size_t const count
+)
+{
+    std::size_t const largeCopy = m_chunkSize * this->getNumThreads( );
+
+    /* small copies are grouped to tasks of about the chunk size, large
+     * copies are split over all threads one by one
+     */
+    std::vector< std::size_t > groupBegin;
+    std::size_t groupBytes = m_chunkSize;
+    for( std::size_t i = 0u; i < count; ++i )
+    {
+        if( sizes[ i ] >= largeCopy )
+        {
+            this->copy( dsts[ i ], srcs[ i ], sizes[ i ] );
+            continue;
+        }
+        if( groupBytes >= m_chunkSize )
+        {
+            groupBegin.push_back( i );
+            groupBytes = 0u;
+        }
+        groupBytes += sizes[ i ];
+    }
+    groupBegin.push_back( count );
+
+    auto const copyGroup = [ & ]( std::size_t const group )
+    {
+        for( std::size_t i = groupBegin[ group ]; i < groupBegin[ group + 1u ]; ++i )
+            if( sizes[ i ] < largeCopy )
+                std::memcpy( dsts[ i ], srcs[ i ], sizes[ i ] );
+    };
+
+    std::size_t const numGroups = groupBegin.size( ) - 1u;
+    if( numGroups == 1u )
+        copyGroup( 0u );
+    else if( numGroups > 1u )
+        this->parallelFor( numGroups, copyGroup );
+}
+
+void
+CopyEngine::set(
+    void * const dst,
+    uint64_t const value,
+    std::size_t const elemSize,
+    std::size_t const bytes
+)
+{
+    auto const dstPtr = static_cast< uint8_t * >( dst );
+    uint64_t const pattern = broadcastPattern( value, elemSize );
+    bool const nonTemporal = bytes >= m_nonTemporalThreshold;
+
+    std::size_t const numChunks = std::min(
+        this->getNumThreads( ),
+        bytes / m_chunkSize
+    );
+
+    if( numChunks <= 1u )
+    {
+        this->setChunk( dstPtr, pattern, bytes, nonTemporal );
+        return;
+    }
+
+    // same page aligned partitioning as copy()
+    std::size_t const head = (
+        pageSize - reinterpret_cast< std::uintptr_t >( dstPtr ) % pageSize
+    ) % pageSize;
+    std::size_t chunkBytes = ( bytes - head + numChunks - 1u ) / numChunks;
+    chunkBytes = ( chunkBytes + pageSize - 1u ) / pageSize * pageSize;
+    std::size_t const size = ( bytes - head + chunkBytes - 1u ) / chunkBytes;
+
+    this->parallelFor(
+        size,
+        [ & ]( std::size_t const i )
+        {
+            std::size_t const begin = i == 0u ? 0u : head + i * chunkBytes;
+            std::size_t const end = std::min( bytes, head + ( i + 1u ) * chunkBytes );
+            this->setChunk(
+                dstPtr + begin,
+                rotatePattern( pattern, begin ),
+                end - begin,
+                nonTemporal
+            );
+        }
+    );
+}
+
+void
+CopyEngine::set3D(
+    void * const dst,
+    std::size_t const pitch,
+    std::size_t const slicePitch,
+    uint64_t const value,
+    std::size_t const elemSize,
+    std::size_t const width,
+    std::size_t const height,
+    std::size_t const depth
+)
+{
+    // the plan is only used for the destination, the padding is never touched
+    detail::CopyPlan const plan(
+        width,
+        height,
+        depth,
+        pitch,
+        slicePitch,
+        pitch,
+        slicePitch
+    );
+
+    if( plan.bytes( ) == 0u )
+        return;
+
+    if( plan.isContiguous( ) )
+    {
+        this->set( dst, value, elemSize, plan.bytes( ) );
+        return;
+    }
+
+    auto const dstPtr = static_cast< uint8_t * >( dst );
+    std::size_t const rowBytes = plan.m_extent[ 0 ];
+    std::size_t const numRows = plan.numRows( );
+
+    if( rowBytes >= m_chunkSize * this->getNumThreads( ) )
+    {
+        for( std::size_t row = 0u; row < numRows; ++row )
+            this->set( dstPtr + plan.dstOffset( row ), value, elemSize, rowBytes );
+        return;
+    }
+
+    // each row starts with the first byte of an element
+    uint64_t const pattern = broadcastPattern( value, elemSize );
+    bool const nonTemporal = plan.bytes( ) >= m_nonTemporalThreshold;
+    std::size_t const rowsPerTask = std::max(
+        ( m_chunkSize + rowBytes - 1u ) / rowBytes,
+        std::size_t( 1u )
+    );
+    std::size_t const numTasks = ( numRows + rowsPerTask - 1u ) / rowsPerTask;
+
+    auto const setRows = [ & ]( std::size_t const task )
+    {
+        std::size_t const end = std::min( numRows, ( task + 1u ) * rowsPerTask );
+        for( std::size_t row = task * rowsPerTask; row < end; ++row )
+            this->setChunk(
+                dstPtr + plan.dstOffset( row ),
+                pattern,
+                rowBytes,
+                nonTemporal
+            );
+    };
+
+    if( numTasks == 1u )
+        setRows( 0u );
+    else
+        this->parallelFor( numTasks, setRows );
+}
+
+} //namespace manager
+} //namespace cupla
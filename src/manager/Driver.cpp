@@ -23,9 +23,11 @@
 #include "cupla_runtime.hpp"
 #include "cupla/manager/Driver.hpp"
 #include "cupla/manager/Memory.hpp"
+#include "cupla/manager/PointerRegistry.hpp"
 #include "cupla/manager/Device.hpp"
 #include "cupla/manager/Stream.hpp"
 #include "cupla/manager/Event.hpp"
+#include "cupla/manager/CopyEngine.hpp"
 
 namespace cupla
 {
@@ -36,6 +38,8 @@ Driver::Driver()
 {
     cupla::manager::Device< cupla::AccDev >::get( );
 
+    cupla::manager::PointerRegistry::get( );
+
     cupla::manager::Stream<
         cupla::AccDev,
         cupla::AccStream
@@ -56,10 +60,23 @@ Driver::Driver()
         cupla::AlpakaDim<1u>
     >::get();
 
+    cupla::manager::Memory<
+        cupla::AccHost,
+        cupla::AlpakaDim<1u>,
+        cuplaMemoryTypeHost
+    >::get();
+
     cupla::manager::Event<
         cupla::AccDev,
         cupla::AccStream
     >::get();
+
+#if !defined(ALPAKA_ACC_GPU_CUDA_ENABLED)
+    /* created before the first stream to outlive the stream workers, the
+     * copy threads are started with the first large copy
+     */
+    cupla::manager::CopyEngine::get();
+#endif
 }
 
 
@@ -22,10 +22,367 @@
 
 #include "cupla_runtime.hpp"
 #include "cupla/manager/Memory.hpp"
+#include "cupla/manager/PointerRegistry.hpp"
+#include "cupla/manager/AllocationTracer.hpp"
 #include "cupla/manager/Device.hpp"
 #include "cupla/manager/Stream.hpp"
 #include "cupla/manager/Event.hpp"
 #include "cupla/api/memory.hpp"
+#include "cupla/detail/CopyPlan.hpp"
+#include "cupla/detail/HostTask.hpp"
+#include "cupla/manager/CopyEngine.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#if defined(ALPAKA_ACC_GPU_CUDA_ENABLED)
+#   include <cuda.h>
+#endif
+
+namespace
+{
+    /** resolve cuplaMemcpyDefault with the pointer registry
+     *
+     * Pointers which are not allocated by cupla are handled as host memory.
+     */
+    auto
+    resolveMemcpyKind(
+        enum cuplaMemcpyKind const kind,
+        void const * const dst,
+        void const * const src
+    )
+    -> enum cuplaMemcpyKind
+    {
+        if( kind != cuplaMemcpyDefault )
+            return kind;
+
+        auto const & registry = cupla::manager::PointerRegistry::get();
+        auto const isDevice = [ &registry ]( void const * const ptr )
+        {
+            cupla::manager::PointerRegistry::Record record;
+            return registry.find( ptr, record ) &&
+                record.type == cuplaMemoryTypeDevice;
+        };
+
+        bool const dstIsDevice = isDevice( dst );
+        if( isDevice( src ) )
+            return dstIsDevice ? cuplaMemcpyDeviceToDevice : cuplaMemcpyDeviceToHost;
+        return dstIsDevice ? cuplaMemcpyHostToDevice : cuplaMemcpyHostToHost;
+    }
+
+    /** check if a zero fill of the memory at devPtr can be skipped
+     *
+     * Only tracked for CUDA devices, the host writes to the memory of CPU
+     * devices without cupla, e.g. with the pointer of
+     * cuplaHostGetDevicePointer().
+     */
+    auto
+    isZeroFilled( void const * const devPtr )
+    -> bool
+    {
+#if defined(ALPAKA_ACC_GPU_CUDA_ENABLED)
+        return cupla::manager::PointerRegistry::get().isPristine( devPtr );
+#else
+        (void) devPtr;
+        return false;
+#endif
+    }
+
+    /** end the zero filled state of the destination of a copy or fill
+     *
+     * Destinations in host memory are never zero filled device memory.
+     */
+    void
+    markWritten(
+        void const * const dst,
+        enum cuplaMemcpyKind const kind = cuplaMemcpyHostToDevice
+    )
+    {
+#if defined(ALPAKA_ACC_GPU_CUDA_ENABLED)
+        if( kind == cuplaMemcpyHostToDevice || kind == cuplaMemcpyDeviceToDevice )
+            cupla::manager::PointerRegistry::get().markWritten( dst );
+#else
+        (void) dst;
+        (void) kind;
+#endif
+    }
+
+    /** host task copying contiguous host memory
+     *
+     * Overlapping memory, e.g. shifting data within an allocation, is
+     * copied with memmove.
+     */
+    auto
+    hostCopyTask(
+        void * const dst,
+        void const * const src,
+        size_t const count
+    )
+    -> cupla::detail::HostTask
+    {
+        auto const dstBytes = static_cast< uint8_t * >( dst );
+        auto const srcBytes = static_cast< uint8_t const * >( src );
+        bool const overlap =
+            dstBytes < srcBytes + count && srcBytes < dstBytes + count;
+
+        return cupla::detail::HostTask(
+            [ dst, src, count, overlap ]( )
+            {
+                if( overlap )
+                    std::memmove( dst, src, count );
+                else
+                    cupla::manager::CopyEngine::get().copy( dst, src, count );
+            }
+        );
+    }
+
+    /** host task copying pitched host memory
+     *
+     * All parameters are captured by value, the caller's parameter structs
+     * can be gone when the task is executed.
+     */
+    auto
+    hostCopy3DTask(
+        void * const dst,
+        size_t const dstPitch,
+        size_t const dstSlicePitch,
+        void const * const src,
+        size_t const srcPitch,
+        size_t const srcSlicePitch,
+        cupla::Extent const extent
+    )
+    -> cupla::detail::HostTask
+    {
+        return cupla::detail::HostTask(
+            [ = ]( )
+            {
+                cupla::manager::CopyEngine::get().copy3D(
+                    dst,
+                    dstPitch,
+                    dstSlicePitch,
+                    src,
+                    srcPitch,
+                    srcSlicePitch,
+                    extent.width,
+                    extent.height,
+                    extent.depth
+                );
+            }
+        );
+    }
+
+    /** fill `height` rows of `width` elements with `elemSize` bytes
+     *
+     * @param value element value, only the lowest `elemSize` bytes are used
+     */
+    auto
+    memsetPatternAsync(
+        void * const devPtr,
+        size_t const pitch,
+        uint64_t const value,
+        size_t const elemSize,
+        size_t const width,
+        size_t const height,
+        cuplaStream_t const stream
+    )
+    -> cuplaError_t
+    {
+        // overlapping rows would write behind the last row
+        if( height > 1u && pitch < width * elemSize )
+            return cuplaErrorInvalidValue;
+
+        // memory from cuplaMallocZeroed() which is not written yet
+        if( value == 0u && isZeroFilled( devPtr ) )
+            return cuplaSuccess;
+        markWritten( devPtr );
+
+        if( width == 0u || height == 0u )
+            return cuplaSuccess;
+
+        auto * const streamObject = cupla::manager::Stream<
+            cupla::AccDev,
+            cupla::AccStream
+        >::get().stream( stream );
+        if( streamObject == nullptr )
+            return cuplaErrorInvalidResourceHandle;
+
+#if !defined(ALPAKA_ACC_GPU_CUDA_ENABLED)
+        ::alpaka::stream::enqueue(
+            *streamObject,
+            cupla::detail::HostTask(
+                [ = ]( )
+                {
+                    cupla::manager::CopyEngine::get().set3D(
+                        devPtr,
+                        pitch,
+                        pitch * height,
+                        value,
+                        elemSize,
+                        width * elemSize,
+                        height,
+                        1u
+                    );
+                }
+            )
+        );
+        return cuplaSuccess;
+#else
+        CUstream const cuStream = reinterpret_cast< CUstream >(
+            streamObject->m_spStreamImpl->m_CudaStream
+        );
+        CUdeviceptr const dst = static_cast< CUdeviceptr >(
+            reinterpret_cast< std::uintptr_t >( devPtr )
+        );
+
+        CUresult result = CUDA_SUCCESS;
+        switch( elemSize )
+        {
+            case 2u:
+                result = height == 1u ?
+                    cuMemsetD16Async(
+                        dst,
+                        static_cast< unsigned short >( value ),
+                        width,
+                        cuStream
+                    ) :
+                    cuMemsetD2D16Async(
+                        dst,
+                        pitch,
+                        static_cast< unsigned short >( value ),
+                        width,
+                        height,
+                        cuStream
+                    );
+            break;
+            case 4u:
+                result = height == 1u ?
+                    cuMemsetD32Async(
+                        dst,
+                        static_cast< unsigned int >( value ),
+                        width,
+                        cuStream
+                    ) :
+                    cuMemsetD2D32Async(
+                        dst,
+                        pitch,
+                        static_cast< unsigned int >( value ),
+                        width,
+                        height,
+                        cuStream
+                    );
+            break;
+            case 8u:
+            {
+                unsigned int const low = static_cast< unsigned int >( value );
+                unsigned int const high = static_cast< unsigned int >( value >> 32u );
+                if( low == high )
+                {
+                    result = cuMemsetD2D32Async(
+                        dst,
+                        pitch,
+                        low,
+                        width * 2u,
+                        height,
+                        cuStream
+                    );
+                    break;
+                }
+                /* there is no 64bit driver memset, both halves of each
+                 * element of the first row are written as a column with a
+                 * pitch of 8 byte
+                 */
+                bool const isContiguous = height == 1u || pitch == width * 8u;
+                size_t const rowElements = isContiguous ? width * height : width;
+                size_t const numRows = isContiguous ? 1u : height;
+                result = cuMemsetD2D32Async(
+                    dst,
+                    8u,
+                    low,
+                    1u,
+                    rowElements,
+                    cuStream
+                );
+                if( result == CUDA_SUCCESS )
+                    result = cuMemsetD2D32Async(
+                        dst + 4u,
+                        8u,
+                        high,
+                        1u,
+                        rowElements,
+                        cuStream
+                    );
+                /* pitched rows are replicated from the already filled rows,
+                 * the number of filled rows doubles with each copy
+                 */
+                for(
+                    size_t filledRows = 1u;
+                    filledRows < numRows && result == CUDA_SUCCESS;
+                    filledRows *= 2u
+                )
+                {
+                    size_t const copyRows = std::min( filledRows, numRows - filledRows );
+                    result = cudaMemcpy2DAsync(
+                        reinterpret_cast< void * >( dst + filledRows * pitch ),
+                        pitch,
+                        devPtr,
+                        pitch,
+                        width * 8u,
+                        copyRows,
+                        cudaMemcpyDeviceToDevice,
+                        streamObject->m_spStreamImpl->m_CudaStream
+                    ) == cudaSuccess ? CUDA_SUCCESS : CUDA_ERROR_INVALID_VALUE;
+                }
+            }
+            break;
+            default:
+                return cuplaErrorInvalidValue;
+        }
+        return result == CUDA_SUCCESS ? cuplaSuccess : cuplaErrorInvalidValue;
+#endif
+    }
+
+    auto
+    memsetPattern(
+        void * const devPtr,
+        size_t const pitch,
+        uint64_t const value,
+        size_t const elemSize,
+        size_t const width,
+        size_t const height
+    )
+    -> cuplaError_t
+    {
+        if( value == 0u && isZeroFilled( devPtr ) )
+            return cuplaSuccess;
+
+        cupla::manager::Stream<
+            cupla::AccDev,
+            cupla::AccStream
+        >::get().waitForBlockingStreams( );
+
+        cuplaError_t const err = memsetPatternAsync(
+            devPtr,
+            pitch,
+            value,
+            elemSize,
+            width,
+            height,
+            0
+        );
+
+        auto& streamObject(
+            *cupla::manager::Stream<
+                cupla::AccDev,
+                cupla::AccStream
+            >::get().stream( 0 )
+        );
+        ::alpaka::wait::wait( streamObject );
+
+        return err;
+    }
+} // namespace
 
 
 cuplaError_t
@@ -33,6 +390,20 @@ cuplaMalloc(
     void **ptrptr,
     size_t size
 )
+{
+    return cuplaMallocWithFlags(
+        ptrptr,
+        size,
+        cuplaMallocDefault
+    );
+}
+
+cuplaError_t
+cuplaMallocWithFlags(
+    void **ptrptr,
+    size_t size,
+    unsigned int flags
+)
 {
 
     const ::alpaka::Vec<
@@ -40,13 +411,75 @@ cuplaMalloc(
         cupla::MemSizeType
     > extent( size );
 
-    auto& buf = cupla::manager::Memory<
+    auto * const block = cupla::manager::Memory<
         cupla::AccDev,
         cupla::AlpakaDim<1u>
-    >::get().alloc( extent );
+    >::get().alloc( extent, flags );
+
+    if( block == nullptr )
+        return cuplaErrorMemoryAllocation;
 
     // @toto catch errors
-    *ptrptr = ::alpaka::mem::view::getPtrNative(buf);
+    *ptrptr = block->ptr();
+
+    auto& registry = cupla::manager::PointerRegistry::get();
+    if(
+        ( flags & cuplaMallocZeroInitialized ) &&
+        !registry.isPristine( *ptrptr )
+    )
+    {
+        // memory is not mapped by cupla, e.g. for CUDA devices
+        cuplaMemset( *ptrptr, 0, size );
+        registry.markPristine( *ptrptr );
+    }
+    return cuplaSuccess;
+}
+
+cuplaError_t
+cuplaMallocZeroed(
+    void **ptrptr,
+    size_t size
+)
+{
+    return cuplaMallocWithFlags(
+        ptrptr,
+        size,
+        cuplaMallocZeroInitialized
+    );
+}
+
+cuplaError_t
+cuplaMallocAsync(
+    void **ptrptr,
+    size_t size,
+    cuplaStream_t stream
+)
+{
+
+    const ::alpaka::Vec<
+        cupla::AlpakaDim<1u>,
+        cupla::MemSizeType
+    > extent( size );
+
+    auto& streamManager = cupla::manager::Stream<
+        cupla::AccDev,
+        cupla::AccStream
+    >::get();
+    // per thread streams are cached by the handle of the thread's stream
+    stream = streamManager.resolve( stream );
+    if( streamManager.stream( stream ) == nullptr )
+        return cuplaErrorInvalidResourceHandle;
+
+    auto * const block = cupla::manager::Memory<
+        cupla::AccDev,
+        cupla::AlpakaDim<1u>
+    >::get().allocAsync( extent, stream );
+
+    if( block == nullptr )
+        return cuplaErrorMemoryAllocation;
+
+    // @toto catch errors
+    *ptrptr = block->ptr();
     return cuplaSuccess;
 }
 
@@ -63,14 +496,17 @@ cuplaMallocPitch(
         cupla::MemSizeType
     > extent( height, width );
 
-    auto& buf = cupla::manager::Memory<
+    auto * const block = cupla::manager::Memory<
         cupla::AccDev,
         cupla::AlpakaDim< 2u >
     >::get().alloc( extent );
 
+    if( block == nullptr )
+        return cuplaErrorMemoryAllocation;
+
     // @toto catch errors
-    *devPtr = ::alpaka::mem::view::getPtrNative(buf);
-    *pitch = ::alpaka::mem::view::getPitchBytes< 1u >( buf );
+    *devPtr = block->ptr();
+    *pitch = block->pitch();
 
     return cuplaSuccess;
 };
@@ -82,15 +518,18 @@ cuplaMalloc3D(
 )
 {
 
-    auto& buf = cupla::manager::Memory<
+    auto * const block = cupla::manager::Memory<
         cupla::AccDev,
         cupla::AlpakaDim< 3u >
     >::get().alloc( extent );
 
+    if( block == nullptr )
+        return cuplaErrorMemoryAllocation;
+
     // @toto catch errors
     *pitchedDevPtr = make_cuplaPitchedPtr(
-        ::alpaka::mem::view::getPtrNative(buf),
-        ::alpaka::mem::view::getPitchBytes< 2u >( buf ),
+        block->ptr(),
+        block->pitch(),
         extent.width,
         extent.height
     );
@@ -134,50 +573,173 @@ cuplaMallocHost(
     void **ptrptr,
     size_t size
 )
+{
+    return cuplaHostAlloc(
+        ptrptr,
+        size,
+        cuplaHostAllocDefault
+    );
+}
+
+cuplaError_t
+cuplaHostAlloc(
+    void **ptrptr,
+    size_t size,
+    unsigned int flags
+)
 {
     const ::alpaka::Vec<
         cupla::AlpakaDim<1u>,
         cupla::MemSizeType
     > extent( size );
 
-    auto& buf = cupla::manager::Memory<
+    auto * const block = cupla::manager::Memory<
         cupla::AccHost,
-        cupla::AlpakaDim<1u>
-    >::get().alloc( extent );
+        cupla::AlpakaDim<1u>,
+        cuplaMemoryTypeHost
+    >::get().alloc( extent, flags );
+
+    if( block == nullptr )
+        return cuplaErrorMemoryAllocation;
 
 #if defined(ALPAKA_ACC_GPU_CUDA_ENABLED)
-    // only implemented if nvcc is used
-    ::alpaka::mem::buf::pin( buf );
+    /* only implemented if nvcc is used
+     * with unified addressing pinned memory is mapped into the device
+     * address space
+     */
+    if( !block->pinned )
+    {
+        // blocks from the cache are still pinned
+        ::alpaka::mem::buf::pin( *block->buf );
+        block->pinned = true;
+    }
 #endif
 
     // @toto catch errors
-    *ptrptr = ::alpaka::mem::view::getPtrNative(buf);
+    *ptrptr = block->ptr();
     return cuplaSuccess;
 }
 
-cuplaError_t cuplaFree(void *ptr)
+cuplaError_t
+cuplaHostGetDevicePointer(
+    void **pDevice,
+    void *pHost,
+    unsigned int
+)
 {
-
+    cupla::manager::PointerRegistry::Record record;
     if(
-        cupla::manager::Memory<
-            cupla::AccDev,
-            cupla::AlpakaDim<1u>
-        >::get().free( ptr )
+        !cupla::manager::PointerRegistry::get().find( pHost, record ) ||
+        record.type != cuplaMemoryTypeHost
     )
-        return cuplaSuccess;
-    else if(
-        cupla::manager::Memory<
-            cupla::AccDev,
-            cupla::AlpakaDim<2u>
-        >::get().free( ptr )
+        return cuplaErrorInvalidValue;
+
+#if defined(ALPAKA_ACC_GPU_CUDA_ENABLED)
+    if( cudaHostGetDevicePointer( pDevice, pHost, 0 ) != cudaSuccess )
+        return cuplaErrorInvalidValue;
+#else
+    // host and device share the memory
+    *pDevice = pHost;
+#endif
+    return cuplaSuccess;
+}
+
+cuplaError_t
+cuplaHostRegister(
+    void *ptr,
+    size_t size,
+    unsigned int flags
+)
+{
+    if( ptr == nullptr || size == 0u )
+        return cuplaErrorInvalidValue;
+
+    if( cupla::manager::PointerRegistry::get().overlaps( ptr, size ) )
+        return cuplaErrorHostMemoryAlreadyRegistered;
+
+#if defined(ALPAKA_ACC_GPU_CUDA_ENABLED)
+    // the cupla flags are equal to the CUDA flags
+    if( cudaHostRegister( ptr, size, flags ) != cudaSuccess )
+        return cuplaErrorInvalidValue;
+#endif
+
+    auto * const block = cupla::manager::Memory<
+        cupla::AccHost,
+        cupla::AlpakaDim<1u>,
+        cuplaMemoryTypeHost
+    >::get().registerMemory( ptr, size, flags );
+
+    // an overlapping range was registered concurrently
+    if( block == nullptr )
+    {
+#if defined(ALPAKA_ACC_GPU_CUDA_ENABLED)
+        cudaHostUnregister( ptr );
+#endif
+        return cuplaErrorHostMemoryAlreadyRegistered;
+    }
+
+    return cuplaSuccess;
+}
+
+cuplaError_t
+cuplaHostUnregister( void *ptr )
+{
+    if(
+        !cupla::manager::Memory<
+            cupla::AccHost,
+            cupla::AlpakaDim<1u>,
+            cuplaMemoryTypeHost
+        >::get().unregisterMemory( ptr )
     )
-        return cuplaSuccess;
-    else if(
-        cupla::manager::Memory<
-            cupla::AccDev,
-            cupla::AlpakaDim<3u>
-        >::get().free( ptr )
+        return cuplaErrorHostMemoryNotRegistered;
+
+#if defined(ALPAKA_ACC_GPU_CUDA_ENABLED)
+    cudaHostUnregister( ptr );
+#endif
+    return cuplaSuccess;
+}
+
+cuplaError_t cuplaFree(void *ptr)
+{
+    cupla::manager::PointerRegistry::Record record;
+    if(
+        !cupla::manager::PointerRegistry::get().findBase( ptr, record ) ||
+        record.type != cuplaMemoryTypeDevice
     )
+        return cuplaErrorMemoryAllocation;
+
+    /* like cudaFree the call synchronizes with the device, all work
+     * which can use the memory is finished before it is reused or released
+     */
+    cupla::manager::Stream<
+        cupla::AccDev,
+        cupla::AccStream
+    >::get().synchronize( );
+
+    bool isFreed = false;
+    switch( record.dim )
+    {
+        case 1u:
+            isFreed = cupla::manager::Memory<
+                cupla::AccDev,
+                cupla::AlpakaDim<1u>
+            >::get().free( ptr );
+            break;
+        case 2u:
+            isFreed = cupla::manager::Memory<
+                cupla::AccDev,
+                cupla::AlpakaDim<2u>
+            >::get().free( ptr );
+            break;
+        case 3u:
+            isFreed = cupla::manager::Memory<
+                cupla::AccDev,
+                cupla::AlpakaDim<3u>
+            >::get().free( ptr );
+            break;
+    }
+
+    if( isFreed )
         return cuplaSuccess;
     else
         return cuplaErrorMemoryAllocation;
@@ -186,11 +748,17 @@ cuplaError_t cuplaFree(void *ptr)
 
 cuplaError_t cuplaFreeHost(void *ptr)
 {
+    // queued copies of any device can still use the memory
+    cupla::manager::Stream<
+        cupla::AccDev,
+        cupla::AccStream
+    >::get().synchronizeAll( );
 
     if(
         cupla::manager::Memory<
             cupla::AccHost,
-            cupla::AlpakaDim<1u>
+            cupla::AlpakaDim<1u>,
+            cuplaMemoryTypeHost
         >::get().free( ptr )
     )
         return cuplaSuccess;
@@ -199,262 +767,945 @@ cuplaError_t cuplaFreeHost(void *ptr)
 
 }
 
-cuplaError_t cuplaMemcpyAsync(
-    void *dst,
-    const void *src,
-    size_t count,
-    enum cuplaMemcpyKind kind,
+cuplaError_t cuplaFreeAsync(
+    void *ptr,
     cuplaStream_t stream
 )
 {
-    const ::alpaka::Vec<
-        cupla::AlpakaDim<1u>,
-        cupla::MemSizeType
-    > numBytes(count);
+    cupla::manager::PointerRegistry::Record record;
+    if(
+        !cupla::manager::PointerRegistry::get().findBase( ptr, record ) ||
+        record.type != cuplaMemoryTypeDevice
+    )
+        return cuplaErrorMemoryAllocation;
 
-    auto& device(
+    auto& streamManager = cupla::manager::Stream<
+        cupla::AccDev,
+        cupla::AccStream
+    >::get();
+    stream = streamManager.resolve( stream );
+    auto * const streamObject = streamManager.stream( stream );
+    if( streamObject == nullptr )
+        return cuplaErrorInvalidResourceHandle;
+    auto const isReady = streamManager.marker( *streamObject );
+
+    bool isFreed = false;
+    switch( record.dim )
+    {
+        case 1u:
+            isFreed = cupla::manager::Memory<
+                cupla::AccDev,
+                cupla::AlpakaDim<1u>
+            >::get().freeAsync( ptr, stream, isReady );
+            break;
+        case 2u:
+            isFreed = cupla::manager::Memory<
+                cupla::AccDev,
+                cupla::AlpakaDim<2u>
+            >::get().freeAsync( ptr, stream, isReady );
+            break;
+        case 3u:
+            isFreed = cupla::manager::Memory<
+                cupla::AccDev,
+                cupla::AlpakaDim<3u>
+            >::get().freeAsync( ptr, stream, isReady );
+            break;
+    }
+
+    if( isFreed )
+        return cuplaSuccess;
+    else
+        return cuplaErrorMemoryAllocation;
+
+}
+
+cuplaError_t
+cuplaPointerGetAttributes(
+    cuplaPointerAttributes * attributes,
+    void const * ptr
+)
+{
+    if( attributes == nullptr )
+        return cuplaErrorInvalidValue;
+
+    cupla::manager::PointerRegistry::Record record;
+    if( !cupla::manager::PointerRegistry::get().find( ptr, record ) )
+    {
+        *attributes = cuplaPointerAttributes();
+        attributes->type = cuplaMemoryTypeUnregistered;
+        attributes->device = -1;
+        attributes->hostPointer = const_cast< void * >( ptr );
+        return cuplaSuccess;
+    }
+
+    attributes->type = record.type;
+    attributes->device = record.device;
+    attributes->devicePointer = nullptr;
+    attributes->hostPointer = nullptr;
+    if( record.type == cuplaMemoryTypeDevice )
+        attributes->devicePointer = const_cast< void * >( ptr );
+    else
+        attributes->hostPointer = const_cast< void * >( ptr );
+    attributes->basePointer = record.base;
+    attributes->size = record.size;
+    attributes->dimension = record.dim;
+    attributes->pitch = record.pitch;
+    attributes->flags = record.flags;
+    attributes->registered = record.registered ? 1 : 0;
+    attributes->hugePages = record.hugePages;
+    attributes->numaPlacement = record.numaPlacement;
+
+    return cuplaSuccess;
+}
+
+cuplaError_t
+cuplaMemCacheSetLimit( size_t bytes )
+{
+    cupla::manager::detail::MemoryCacheBudget<
+        cupla::AccDev,
+        cuplaMemoryTypeDevice
+    >::get().m_limit = bytes;
+
+    return cuplaMemCacheTrim( bytes );
+}
+
+cuplaError_t
+cuplaMemSetCapacity( size_t bytes )
+{
+    cupla::manager::detail::MemoryCacheBudget<
+        cupla::AccDev,
+        cuplaMemoryTypeDevice
+    >::get().setCapacity(
         cupla::manager::Device<
             cupla::AccDev
-        >::get().current()
+        >::get().id(),
+        bytes
     );
 
-    auto& streamObject(
-        cupla::manager::Stream<
-            cupla::AccDev,
-            cupla::AccStream
-        >::get().stream( stream )
+    return cuplaSuccess;
+}
+
+cuplaError_t
+cuplaMemGetPoolStats( cuplaMemPoolStats * stats )
+{
+    if( stats == nullptr )
+        return cuplaErrorInvalidValue;
+
+    *stats = cupla::manager::detail::MemoryCacheBudget<
+        cupla::AccDev,
+        cuplaMemoryTypeDevice
+    >::get().stats(
+        cupla::manager::Device<
+            cupla::AccDev
+        >::get().id()
     );
 
-    switch(kind)
-    {
-        case cuplaMemcpyHostToDevice:
-        {
-            auto& host(
-                cupla::manager::Device<
-                    cupla::AccHost
-                >::get().current()
-            );
+    return cuplaSuccess;
+}
 
-            const cupla::HostBufWrapper< 1u > hBuf(
-                const_cast<uint8_t *>(
-                    static_cast<const uint8_t *>(src)
-                ),
-                host,
-                numBytes
-            );
-            cupla::DeviceBufWrapper< 1u > dBuf(
-                static_cast<uint8_t *>(
-                    dst
-                ),
-                device,
-                numBytes
-            );
+cuplaError_t
+cuplaAllocTraceSetTag( char const * tag )
+{
+    cupla::manager::AllocationTracer::get().setTag( tag );
+    return cuplaSuccess;
+}
 
-            ::alpaka::mem::view::copy(
-                streamObject,
-                dBuf,
-                hBuf,
-                numBytes
-            );
+cuplaError_t
+cuplaAllocTraceDump( char const * fileName )
+{
+    auto& tracer = cupla::manager::AllocationTracer::get();
+    if( !tracer.isEnabled() )
+        return cuplaErrorInvalidValue;
+    if( !tracer.dump( fileName ) )
+        return cuplaErrorInvalidValue;
+    return cuplaSuccess;
+}
 
-        }
-            break;
-        case cuplaMemcpyDeviceToHost:
-        {
-            auto& host(
-                cupla::manager::Device<
-                    cupla::AccHost
-                >::get().current()
-            );
-            const cupla::DeviceBufWrapper< 1u > dBuf(
-                const_cast<uint8_t *>(
-                    static_cast<const uint8_t *>(src)
-                ),
-                device,
-                numBytes
-            );
-            cupla::HostBufWrapper< 1u > hBuf(
-                static_cast<uint8_t *>(
-                    dst
-                ),
-                host,
-                numBytes
-            );
+cuplaError_t
+cuplaMemSetHugePageThreshold( size_t bytes )
+{
+    cupla::manager::detail::HugePagePolicy::get().m_threshold = bytes;
+    return cuplaSuccess;
+}
 
-            ::alpaka::mem::view::copy(
-                streamObject,
-                hBuf,
-                dBuf,
-                numBytes
-            );
+cuplaError_t
+cuplaMemSetNumaPlacement( enum cuplaNumaPlacement placement )
+{
+    cupla::manager::detail::NumaPolicy::get().m_placement = placement;
+    return cuplaSuccess;
+}
 
-        }
-            break;
-        case cuplaMemcpyDeviceToDevice:
-        {
-            const cupla::DeviceBufWrapper< 1u > dSrcBuf(
-                const_cast<uint8_t *>(
-                    static_cast<const uint8_t *>(src)
-                ),
-                device,
-                numBytes
-            );
-            cupla::DeviceBufWrapper< 1u > dDestBuf(
-                static_cast<uint8_t *>(
-                    dst
-                ),
-                device,
-                numBytes
-            );
+cuplaError_t
+cuplaMemCacheTrim( size_t minBytesToKeep )
+{
+    cupla::manager::Memory<
+        cupla::AccDev,
+        cupla::AlpakaDim<1u>
+    >::get().trim( minBytesToKeep );
 
-            ::alpaka::mem::view::copy(
-                streamObject,
-                dDestBuf,
-                dSrcBuf,
-                numBytes
-            );
+    cupla::manager::Memory<
+        cupla::AccDev,
+        cupla::AlpakaDim<2u>
+    >::get().trim( minBytesToKeep );
 
-        }
+    cupla::manager::Memory<
+        cupla::AccDev,
+        cupla::AlpakaDim<3u>
+    >::get().trim( minBytesToKeep );
+
+    return cuplaSuccess;
+}
+
+cuplaError_t
+cuplaHostMemCacheSetLimit( size_t bytes )
+{
+    cupla::manager::detail::MemoryCacheBudget<
+        cupla::AccHost,
+        cuplaMemoryTypeHost
+    >::get().m_limit = bytes;
+
+    return cuplaHostMemCacheTrim( bytes );
+}
+
+cuplaError_t
+cuplaHostMemCacheTrim( size_t minBytesToKeep )
+{
+    cupla::manager::Memory<
+        cupla::AccHost,
+        cupla::AlpakaDim<1u>,
+        cuplaMemoryTypeHost
+    >::get().trim( minBytesToKeep );
+
+    return cuplaSuccess;
+}
+
+cuplaError_t
+cuplaHostMemGetPoolStats( cuplaMemPoolStats * stats )
+{
+    if( stats == nullptr )
+        return cuplaErrorInvalidValue;
+
+    *stats = cupla::manager::detail::MemoryCacheBudget<
+        cupla::AccHost,
+        cuplaMemoryTypeHost
+    >::get().stats(
+        cupla::manager::Device<
+            cupla::AccHost
+        >::get().id()
+    );
+
+    return cuplaSuccess;
+}
+
+namespace
+{
+    /** enqueue a contiguous copy
+     *
+     * @param kind resolved kind of the copy, not cuplaMemcpyDefault
+     */
+    auto
+    memcpyAsync(
+        void * const dst,
+        void const * const src,
+        size_t const count,
+        enum cuplaMemcpyKind const kind,
+        cuplaStream_t const stream
+    )
+    -> cuplaError_t
+    {
+        const ::alpaka::Vec<
+            cupla::AlpakaDim<1u>,
+            cupla::MemSizeType
+        > numBytes(count);
+
+        auto * const streamObject = cupla::manager::Stream<
+            cupla::AccDev,
+            cupla::AccStream
+        >::get().stream( stream );
+        if( streamObject == nullptr )
+            return cuplaErrorInvalidResourceHandle;
+
+#if !defined(ALPAKA_ACC_GPU_CUDA_ENABLED)
+        /* all memory of CPU accelerators is host memory, the copy is executed
+         * by the copy engine in order with the other work of the stream
+         */
+        ::alpaka::stream::enqueue( *streamObject, hostCopyTask( dst, src, count ) );
+#else
+        auto& device(
+            cupla::manager::Device<
+                cupla::AccDev
+            >::get().current()
+        );
+
+        switch(kind)
+        {
+            case cuplaMemcpyHostToDevice:
+            {
+                auto& host(
+                    cupla::manager::Device<
+                        cupla::AccHost
+                    >::get().current()
+                );
+
+                const cupla::HostBufWrapper< 1u > hBuf(
+                    const_cast<uint8_t *>(
+                        static_cast<const uint8_t *>(src)
+                    ),
+                    host,
+                    numBytes
+                );
+                cupla::DeviceBufWrapper< 1u > dBuf(
+                    static_cast<uint8_t *>(
+                        dst
+                    ),
+                    device,
+                    numBytes
+                );
+
+                ::alpaka::mem::view::copy(
+                    *streamObject,
+                    dBuf,
+                    hBuf,
+                    numBytes
+                );
+
+            }
+                break;
+            case cuplaMemcpyDeviceToHost:
+            {
+                auto& host(
+                    cupla::manager::Device<
+                        cupla::AccHost
+                    >::get().current()
+                );
+                const cupla::DeviceBufWrapper< 1u > dBuf(
+                    const_cast<uint8_t *>(
+                        static_cast<const uint8_t *>(src)
+                    ),
+                    device,
+                    numBytes
+                );
+                cupla::HostBufWrapper< 1u > hBuf(
+                    static_cast<uint8_t *>(
+                        dst
+                    ),
+                    host,
+                    numBytes
+                );
+
+                ::alpaka::mem::view::copy(
+                    *streamObject,
+                    hBuf,
+                    dBuf,
+                    numBytes
+                );
+
+            }
+                break;
+            case cuplaMemcpyDeviceToDevice:
+            {
+                const cupla::DeviceBufWrapper< 1u > dSrcBuf(
+                    const_cast<uint8_t *>(
+                        static_cast<const uint8_t *>(src)
+                    ),
+                    device,
+                    numBytes
+                );
+                cupla::DeviceBufWrapper< 1u > dDestBuf(
+                    static_cast<uint8_t *>(
+                        dst
+                    ),
+                    device,
+                    numBytes
+                );
+
+                ::alpaka::mem::view::copy(
+                    *streamObject,
+                    dDestBuf,
+                    dSrcBuf,
+                    numBytes
+                );
+
+            }
+                break;
+            case cuplaMemcpyHostToHost:
+                // executed by the host in order with the work of the stream
+                ::alpaka::stream::enqueue(
+                    *streamObject,
+                    hostCopyTask( dst, src, count )
+                );
             break;
-        case cuplaMemcpyHostToHost:
+            case cuplaMemcpyDefault:
+                // already resolved by resolveMemcpyKind()
+            break;
+        }
+#endif
+        return cuplaSuccess;
+    }
+} // namespace
+
+cuplaError_t cuplaMemcpyAsync(
+    void *dst,
+    const void *src,
+    size_t count,
+    enum cuplaMemcpyKind kind,
+    cuplaStream_t stream
+)
+{
+    /* source and destination are the same memory e.g. mapped host memory
+     * accessed with the pointer from cuplaHostGetDevicePointer()
+     */
+    if( dst == src )
+        return cuplaSuccess;
+
+    kind = resolveMemcpyKind( kind, dst, src );
+    markWritten( dst, kind );
+
+    return memcpyAsync( dst, src, count, kind, stream );
+}
+
+cuplaError_t
+cuplaMemcpyBatchAsync(
+    void * const * const dsts,
+    void const * const * const srcs,
+    size_t const * const sizes,
+    size_t const count,
+    enum cuplaMemcpyKind kind,
+    cuplaStream_t stream
+)
+{
+    if( count == 0u )
+        return cuplaSuccess;
+
+    if( dsts == nullptr || srcs == nullptr || sizes == nullptr )
+        return cuplaErrorInvalidValue;
+
+#if !defined(ALPAKA_ACC_GPU_CUDA_ENABLED)
+    // the caller can reuse the arrays after the call
+    struct Batch
+    {
+        std::vector< void * > dsts;
+        std::vector< void const * > srcs;
+        std::vector< size_t > sizes;
+    };
+    auto const batch = std::make_shared< Batch >( );
+    batch->dsts.assign( dsts, dsts + count );
+    batch->srcs.assign( srcs, srcs + count );
+    batch->sizes.assign( sizes, sizes + count );
+
+    const cupla::detail::HostTask copyTask(
+        [ batch ]( )
         {
-            auto& hostStreamObject(
-                cupla::manager::Stream<
-                    cupla::AccHost,
-                    cupla::AccHostStream
-                >::get().stream( stream )
-            );
-            auto& host(
-                cupla::manager::Device<
-                    cupla::AccHost
-                >::get().current()
-            );
-            const cupla::HostBufWrapper< 1u > hSrcBuf(
-                const_cast<uint8_t *>(
-                    static_cast<const uint8_t *>(src)
-                ),
-                host,
-                numBytes
-            );
-            cupla::HostBufWrapper< 1u > hDestBuf(
-                static_cast<uint8_t *>(
-                    dst
-                ),
-                host,
-                numBytes
+            cupla::manager::CopyEngine::get().copyBatch(
+                batch->dsts.data( ),
+                batch->srcs.data( ),
+                batch->sizes.data( ),
+                batch->sizes.size( )
             );
+        }
+    );
+
+    auto * const streamObject = cupla::manager::Stream<
+        cupla::AccDev,
+        cupla::AccStream
+    >::get().stream( stream );
+    if( streamObject == nullptr )
+        return cuplaErrorInvalidResourceHandle;
+
+    ::alpaka::stream::enqueue( *streamObject, copyTask );
+#else
+    /* one new write epoch for the whole batch instead of a registry lookup
+     * per copy, see markWritten()
+     */
+    if( kind != cuplaMemcpyDeviceToHost && kind != cuplaMemcpyHostToHost )
+        ++cupla::manager::PointerRegistry::writeEpoch();
+
+    for( size_t i = 0u; i < count; ++i )
+    {
+        if( dsts[ i ] == srcs[ i ] )
+            continue;
+        cuplaError_t const err = memcpyAsync(
+            dsts[ i ],
+            srcs[ i ],
+            sizes[ i ],
+            resolveMemcpyKind( kind, dsts[ i ], srcs[ i ] ),
+            stream
+        );
+        if( err != cuplaSuccess )
+            return err;
+    }
+#endif
+    return cuplaSuccess;
+}
+
+cuplaError_t
+cuplaMemcpy(
+    void *dst,
+    const void *src,
+    size_t count,
+    enum cuplaMemcpyKind kind
+)
+{
+    cupla::manager::Stream<
+        cupla::AccDev,
+        cupla::AccStream
+    >::get().waitForBlockingStreams( );
+
+    cuplaError_t const err = cuplaMemcpyAsync(
+        dst,
+        src,
+        count,
+        kind,
+        0
+    );
+
+    auto& streamObject(
+        *cupla::manager::Stream<
+            cupla::AccDev,
+            cupla::AccStream
+        >::get().stream( 0 )
+    );
+    ::alpaka::wait::wait( streamObject );
+
+    return err;
+}
+
+cuplaError_t
+cuplaMemsetAsync(
+    void * devPtr,
+    int value,
+    size_t count,
+    cuplaStream_t stream
+)
+{
+    // memory from cuplaMallocZeroed() which is not written yet
+    if( value == 0 && isZeroFilled( devPtr ) )
+        return cuplaSuccess;
+    markWritten( devPtr );
+
+    auto& device(
+        cupla::manager::Device<
+            cupla::AccDev
+        >::get().current()
+    );
+
+    auto * const streamObject = cupla::manager::Stream<
+        cupla::AccDev,
+        cupla::AccStream
+    >::get().stream( stream );
+    if( streamObject == nullptr )
+        return cuplaErrorInvalidResourceHandle;
+
+    ::alpaka::Vec<
+        cupla::AlpakaDim<1u>,
+        cupla::MemSizeType
+    > const
+    numBytes(count);
+
+    cupla::DeviceBufWrapper< 1u >
+    dBuf(
+        static_cast< uint8_t * >( devPtr ),
+        device,
+        numBytes
+    );
+
+    ::alpaka::mem::view::set(
+        *streamObject,
+        dBuf,
+        value,
+        numBytes
+    );
+
+    return cuplaSuccess;
+}
+
+cuplaError_t
+cuplaMemset(
+    void * devPtr,
+    int value,
+    size_t count
+)
+{
+    if( value == 0 && isZeroFilled( devPtr ) )
+        return cuplaSuccess;
+
+    cupla::manager::Stream<
+        cupla::AccDev,
+        cupla::AccStream
+    >::get().waitForBlockingStreams( );
+
+    cuplaError_t const err = cuplaMemsetAsync(
+        devPtr,
+        value,
+        count,
+        0
+    );
+
+    auto& streamObject(
+        *cupla::manager::Stream<
+            cupla::AccDev,
+            cupla::AccStream
+        >::get().stream( 0 )
+    );
+    ::alpaka::wait::wait( streamObject );
+
+    return err;
+}
+
+cuplaError_t
+cuplaMemset2DAsync(
+    void * devPtr,
+    size_t pitch,
+    int value,
+    size_t width,
+    size_t height,
+    cuplaStream_t stream
+)
+{
+    return cuplaMemset3DAsync(
+        make_cuplaPitchedPtr( devPtr, pitch, width, height ),
+        value,
+        make_cuplaExtent( width, height, 1u ),
+        stream
+    );
+}
+
+cuplaError_t
+cuplaMemset2D(
+    void * devPtr,
+    size_t pitch,
+    int value,
+    size_t width,
+    size_t height
+)
+{
+    return cuplaMemset3D(
+        make_cuplaPitchedPtr( devPtr, pitch, width, height ),
+        value,
+        make_cuplaExtent( width, height, 1u )
+    );
+}
+
+cuplaError_t
+cuplaMemset3DAsync(
+    cupla::PitchedPtr pitchedDevPtr,
+    int value,
+    cupla::Extent extent,
+    cuplaStream_t stream
+)
+{
+    // overlapping rows or slices would write behind the last slice
+    if(
+        ( extent.height > 1u || extent.depth > 1u ) &&
+        pitchedDevPtr.pitch < extent.width
+    )
+        return cuplaErrorInvalidValue;
+    if( extent.depth > 1u && pitchedDevPtr.ysize < extent.height )
+        return cuplaErrorInvalidValue;
+
+    // memory from cuplaMallocZeroed() which is not written yet
+    if( value == 0 && isZeroFilled( pitchedDevPtr.ptr ) )
+        return cuplaSuccess;
+    markWritten( pitchedDevPtr.ptr );
+
+    if( extent.width == 0u || extent.height == 0u || extent.depth == 0u )
+        return cuplaSuccess;
+
+    auto * const streamObject = cupla::manager::Stream<
+        cupla::AccDev,
+        cupla::AccStream
+    >::get().stream( stream );
+    if( streamObject == nullptr )
+        return cuplaErrorInvalidResourceHandle;
+
+#if !defined(ALPAKA_ACC_GPU_CUDA_ENABLED)
+    // all memory of CPU accelerators is host memory
+    void * const dst = pitchedDevPtr.ptr;
+    const size_t pitch = pitchedDevPtr.pitch;
+    const size_t slicePitch = pitchedDevPtr.pitch * pitchedDevPtr.ysize;
+    const uint8_t byte = static_cast< uint8_t >( value );
+    ::alpaka::stream::enqueue(
+        *streamObject,
+        cupla::detail::HostTask(
+            [ = ]( )
+            {
+                cupla::manager::CopyEngine::get().set3D(
+                    dst,
+                    pitch,
+                    slicePitch,
+                    byte,
+                    1u,
+                    extent.width,
+                    extent.height,
+                    extent.depth
+                );
+            }
+        )
+    );
+#else
+    auto& device(
+        cupla::manager::Device<
+            cupla::AccDev
+        >::get().current()
+    );
+
+    const ::alpaka::Vec<
+        cupla::AlpakaDim<3u>,
+        cupla::MemSizeType
+    > numBytes( extent );
+
+    const ::alpaka::Vec<
+        cupla::AlpakaDim<3u>,
+        cupla::MemSizeType
+    > extentDst(
+        pitchedDevPtr.xsize * pitchedDevPtr.ysize * extent.depth,
+        pitchedDevPtr.xsize * pitchedDevPtr.ysize,
+        pitchedDevPtr.xsize
+    );
 
-            ::alpaka::mem::view::copy(
-                hostStreamObject,
-                hDestBuf,
-                hSrcBuf,
-                numBytes
-            );
+    const ::alpaka::Vec<
+        cupla::AlpakaDim<3u>,
+        cupla::MemSizeType
+    > dstPitch(
+        pitchedDevPtr.pitch * pitchedDevPtr.ysize * extent.depth, // @todo: can't create z pitch,  but is not needed by alpaka
+        pitchedDevPtr.pitch * pitchedDevPtr.ysize,
+        pitchedDevPtr.pitch
+    );
 
-        }
-        break;
-    }
+    cupla::DeviceBufWrapper< 3u > dBuf(
+        static_cast< uint8_t * >( pitchedDevPtr.ptr ),
+        device,
+        extentDst,
+        dstPitch
+    );
+
+    ::alpaka::mem::view::set(
+        *streamObject,
+        dBuf,
+        value,
+        numBytes
+    );
+#endif
     return cuplaSuccess;
 }
 
 cuplaError_t
-cuplaMemcpy(
-    void *dst,
-    const void *src,
-    size_t count,
-    enum cuplaMemcpyKind kind
+cuplaMemset3D(
+    cupla::PitchedPtr pitchedDevPtr,
+    int value,
+    cupla::Extent extent
 )
 {
-    cuplaDeviceSynchronize();
+    if( value == 0 && isZeroFilled( pitchedDevPtr.ptr ) )
+        return cuplaSuccess;
 
-    cuplaMemcpyAsync(
-        dst,
-        src,
-        count,
-        kind,
+    cupla::manager::Stream<
+        cupla::AccDev,
+        cupla::AccStream
+    >::get().waitForBlockingStreams( );
+
+    cuplaError_t const err = cuplaMemset3DAsync(
+        pitchedDevPtr,
+        value,
+        extent,
         0
     );
 
     auto& streamObject(
-        cupla::manager::Stream<
+        *cupla::manager::Stream<
             cupla::AccDev,
             cupla::AccStream
         >::get().stream( 0 )
     );
     ::alpaka::wait::wait( streamObject );
 
-    return cuplaSuccess;
+    return err;
 }
 
 cuplaError_t
-cuplaMemsetAsync(
+cuplaMemsetD16Async(
     void * devPtr,
-    int value,
+    unsigned short value,
     size_t count,
     cuplaStream_t stream
 )
 {
-    auto& device(
-        cupla::manager::Device<
-            cupla::AccDev
-        >::get().current()
+    return memsetPatternAsync(
+        devPtr,
+        count * 2u,
+        value,
+        2u,
+        count,
+        1u,
+        stream
     );
+}
 
-    auto& streamObject(
-        cupla::manager::Stream<
-            cupla::AccDev,
-            cupla::AccStream
-        >::get().stream( stream )
+cuplaError_t
+cuplaMemsetD16(
+    void * devPtr,
+    unsigned short value,
+    size_t count
+)
+{
+    return memsetPattern( devPtr, count * 2u, value, 2u, count, 1u );
+}
+
+cuplaError_t
+cuplaMemsetD2D16Async(
+    void * devPtr,
+    size_t pitch,
+    unsigned short value,
+    size_t width,
+    size_t height,
+    cuplaStream_t stream
+)
+{
+    return memsetPatternAsync(
+        devPtr,
+        pitch,
+        value,
+        2u,
+        width,
+        height,
+        stream
     );
+}
 
-    ::alpaka::Vec<
-        cupla::AlpakaDim<1u>,
-        cupla::MemSizeType
-    > const
-    numBytes(count);
+cuplaError_t
+cuplaMemsetD2D16(
+    void * devPtr,
+    size_t pitch,
+    unsigned short value,
+    size_t width,
+    size_t height
+)
+{
+    return memsetPattern( devPtr, pitch, value, 2u, width, height );
+}
 
-    cupla::DeviceBufWrapper< 1u >
-    dBuf(
-        static_cast< uint8_t * >( devPtr ),
-        device,
-        numBytes
+cuplaError_t
+cuplaMemsetD32Async(
+    void * devPtr,
+    unsigned int value,
+    size_t count,
+    cuplaStream_t stream
+)
+{
+    return memsetPatternAsync(
+        devPtr,
+        count * 4u,
+        value,
+        4u,
+        count,
+        1u,
+        stream
     );
+}
 
-    ::alpaka::mem::view::set(
-        streamObject,
-        dBuf,
+cuplaError_t
+cuplaMemsetD32(
+    void * devPtr,
+    unsigned int value,
+    size_t count
+)
+{
+    return memsetPattern( devPtr, count * 4u, value, 4u, count, 1u );
+}
+
+cuplaError_t
+cuplaMemsetD2D32Async(
+    void * devPtr,
+    size_t pitch,
+    unsigned int value,
+    size_t width,
+    size_t height,
+    cuplaStream_t stream
+)
+{
+    return memsetPatternAsync(
+        devPtr,
+        pitch,
         value,
-        numBytes
+        4u,
+        width,
+        height,
+        stream
     );
-
-    return cuplaSuccess;
 }
 
 cuplaError_t
-cuplaMemset(
+cuplaMemsetD2D32(
     void * devPtr,
-    int value,
-    size_t count
+    size_t pitch,
+    unsigned int value,
+    size_t width,
+    size_t height
 )
 {
-    cuplaDeviceSynchronize();
+    return memsetPattern( devPtr, pitch, value, 4u, width, height );
+}
 
-    cuplaMemsetAsync(
+cuplaError_t
+cuplaMemsetD64Async(
+    void * devPtr,
+    unsigned long long value,
+    size_t count,
+    cuplaStream_t stream
+)
+{
+    return memsetPatternAsync(
         devPtr,
+        count * 8u,
         value,
+        8u,
         count,
-        0
+        1u,
+        stream
     );
+}
 
-    auto& streamObject(
-        cupla::manager::Stream<
-            cupla::AccDev,
-            cupla::AccStream
-        >::get().stream( 0 )
+cuplaError_t
+cuplaMemsetD64(
+    void * devPtr,
+    unsigned long long value,
+    size_t count
+)
+{
+    return memsetPattern( devPtr, count * 8u, value, 8u, count, 1u );
+}
+
+cuplaError_t
+cuplaMemsetD2D64Async(
+    void * devPtr,
+    size_t pitch,
+    unsigned long long value,
+    size_t width,
+    size_t height,
+    cuplaStream_t stream
+)
+{
+    return memsetPatternAsync(
+        devPtr,
+        pitch,
+        value,
+        8u,
+        width,
+        height,
+        stream
     );
-    ::alpaka::wait::wait( streamObject );
+}
 
-    return cuplaSuccess;
+cuplaError_t
+cuplaMemsetD2D64(
+    void * devPtr,
+    size_t pitch,
+    unsigned long long value,
+    size_t width,
+    size_t height
+)
+{
+    return memsetPattern( devPtr, pitch, value, 8u, width, height );
 }
 
 cuplaError_t
@@ -469,6 +1720,27 @@ cuplaMemcpy2DAsync(
     cuplaStream_t const stream
 )
 {
+    // source and destination are the same memory
+    if( dst == src && dPitch == sPitch )
+        return cuplaSuccess;
+
+    kind = resolveMemcpyKind( kind, dst, src );
+    markWritten( dst, kind );
+
+    const cupla::detail::CopyPlan plan(
+        width,
+        height,
+        1u,
+        dPitch,
+        dPitch * height,
+        sPitch,
+        sPitch * height
+    );
+
+    // copies without gaps are executed as one dimensional copy
+    if( plan.isContiguous( ) )
+        return cuplaMemcpyAsync( dst, src, plan.bytes( ), kind, stream );
+
     const ::alpaka::Vec<
         cupla::AlpakaDim<2u>,
         cupla::MemSizeType
@@ -484,19 +1756,34 @@ cuplaMemcpy2DAsync(
         cupla::MemSizeType
     > srcPitch( sPitch * height , sPitch );
 
+    auto * const streamObject = cupla::manager::Stream<
+        cupla::AccDev,
+        cupla::AccStream
+    >::get().stream( stream );
+    if( streamObject == nullptr )
+        return cuplaErrorInvalidResourceHandle;
+
+#if !defined(ALPAKA_ACC_GPU_CUDA_ENABLED)
+    // all memory of CPU accelerators is host memory
+    ::alpaka::stream::enqueue(
+        *streamObject,
+        hostCopy3DTask(
+            dst,
+            dPitch,
+            dPitch * height,
+            src,
+            sPitch,
+            sPitch * height,
+            cupla::Extent( width, height, 1u )
+        )
+    );
+#else
     auto& device(
         cupla::manager::Device<
             cupla::AccDev
         >::get().current()
     );
 
-    auto& streamObject(
-        cupla::manager::Stream<
-            cupla::AccDev,
-            cupla::AccStream
-        >::get().stream( stream )
-    );
-
     switch(kind)
     {
         case cuplaMemcpyHostToDevice:
@@ -525,7 +1812,7 @@ cuplaMemcpy2DAsync(
             );
 
             ::alpaka::mem::view::copy(
-                streamObject,
+                *streamObject,
                 dBuf,
                 hBuf,
                 numBytes
@@ -558,7 +1845,7 @@ cuplaMemcpy2DAsync(
             );
 
             ::alpaka::mem::view::copy(
-                streamObject,
+                *streamObject,
                 hBuf,
                 dBuf,
                 numBytes
@@ -586,7 +1873,7 @@ cuplaMemcpy2DAsync(
             );
 
             ::alpaka::mem::view::copy(
-                streamObject,
+                *streamObject,
                 dDestBuf,
                 dSrcBuf,
                 numBytes
@@ -595,45 +1882,25 @@ cuplaMemcpy2DAsync(
         }
         break;
         case cuplaMemcpyHostToHost:
-        {
-             auto& hostStreamObject(
-                cupla::manager::Stream<
-                    cupla::AccHost,
-                    cupla::AccHostStream
-                >::get().stream( stream )
-            );
-            auto& host(
-                cupla::manager::Device<
-                    cupla::AccHost
-                >::get().current()
-            );
-            const cupla::HostBufWrapper< 2u > hSrcBuf(
-                const_cast<uint8_t *>(
-                    static_cast<const uint8_t *>(src)
-                ),
-                host,
-                numBytes,
-                srcPitch
-            );
-            cupla::HostBufWrapper< 2u > hDestBuf(
-                static_cast<uint8_t *>(
-                    dst
-                ),
-                host,
-                numBytes,
-                dstPitch
+            // executed by the host in order with the work of the stream
+            ::alpaka::stream::enqueue(
+                *streamObject,
+                hostCopy3DTask(
+                    dst,
+                    dPitch,
+                    dPitch * height,
+                    src,
+                    sPitch,
+                    sPitch * height,
+                    cupla::Extent( width, height, 1u )
+                )
             );
-
-            ::alpaka::mem::view::copy(
-                hostStreamObject,
-                hDestBuf,
-                hSrcBuf,
-                numBytes
-            );
-
-        }
+        break;
+        case cuplaMemcpyDefault:
+            // already resolved by resolveMemcpyKind()
         break;
     }
+#endif
     return cuplaSuccess;
 }
 
@@ -648,9 +1915,12 @@ cuplaMemcpy2D(
     enum cuplaMemcpyKind kind
 )
 {
-    cuplaDeviceSynchronize();
+    cupla::manager::Stream<
+        cupla::AccDev,
+        cupla::AccStream
+    >::get().waitForBlockingStreams( );
 
-    cuplaMemcpy2DAsync(
+    cuplaError_t const err = cuplaMemcpy2DAsync(
         dst,
         dPitch,
         src,
@@ -662,14 +1932,14 @@ cuplaMemcpy2D(
     );
 
     auto& streamObject(
-        cupla::manager::Stream<
+        *cupla::manager::Stream<
             cupla::AccDev,
             cupla::AccStream
         >::get().stream( 0 )
     );
     ::alpaka::wait::wait( streamObject );
 
-    return cuplaSuccess;
+    return err;
 }
 
 cuplaError_t
@@ -678,6 +1948,35 @@ cuplaMemcpy3DAsync(
     cuplaStream_t stream
 )
 {
+    const size_t dstSlicePitch = p->dstPtr.pitch * p->dstPtr.ysize;
+    const size_t srcSlicePitch = p->srcPtr.pitch * p->srcPtr.ysize;
+
+    // first byte of the copied region
+    uint8_t * const dst = static_cast< uint8_t * >( p->dstPtr.ptr ) +
+        p->dstPos.z * dstSlicePitch +
+        p->dstPos.y * p->dstPtr.pitch +
+        p->dstPos.x;
+    uint8_t const * const src = static_cast< uint8_t const * >( p->srcPtr.ptr ) +
+        p->srcPos.z * srcSlicePitch +
+        p->srcPos.y * p->srcPtr.pitch +
+        p->srcPos.x;
+
+    const cupla::detail::CopyPlan plan(
+        p->extent.width,
+        p->extent.height,
+        p->extent.depth,
+        p->dstPtr.pitch,
+        dstSlicePitch,
+        p->srcPtr.pitch,
+        srcSlicePitch
+    );
+
+    const enum cuplaMemcpyKind kind = resolveMemcpyKind( p->kind, dst, src );
+    markWritten( dst, kind );
+
+    // copies without gaps are executed as one dimensional copy
+    if( plan.isContiguous( ) )
+        return cuplaMemcpyAsync( dst, src, plan.bytes( ), kind, stream );
     const ::alpaka::Vec<
         cupla::AlpakaDim<3u>,
         cupla::MemSizeType
@@ -737,20 +2036,35 @@ cuplaMemcpy3DAsync(
         p->srcPtr.pitch
     );
 
+    auto * const streamObject = cupla::manager::Stream<
+        cupla::AccDev,
+        cupla::AccStream
+    >::get().stream( stream );
+    if( streamObject == nullptr )
+        return cuplaErrorInvalidResourceHandle;
+
+#if !defined(ALPAKA_ACC_GPU_CUDA_ENABLED)
+    // all memory of CPU accelerators is host memory
+    ::alpaka::stream::enqueue(
+        *streamObject,
+        hostCopy3DTask(
+            dst,
+            p->dstPtr.pitch,
+            dstSlicePitch,
+            src,
+            p->srcPtr.pitch,
+            srcSlicePitch,
+            p->extent
+        )
+    );
+#else
     auto& device(
         cupla::manager::Device<
             cupla::AccDev
         >::get().current()
     );
 
-    auto& streamObject(
-        cupla::manager::Stream<
-            cupla::AccDev,
-            cupla::AccStream
-        >::get().stream( stream )
-    );
-
-    switch(p->kind)
+    switch(kind)
     {
         case cuplaMemcpyHostToDevice:
         {
@@ -784,7 +2098,7 @@ cuplaMemcpy3DAsync(
             );
 
             ::alpaka::mem::view::copy(
-                streamObject,
+                *streamObject,
                 dView,
                 cupla::HostViewWrapper< 3u >(
                     hBuf,
@@ -827,7 +2141,7 @@ cuplaMemcpy3DAsync(
             );
 
             ::alpaka::mem::view::copy(
-                streamObject,
+                *streamObject,
                 hView,
                 cupla::DeviceViewWrapper< 3u >(
                     dBuf,
@@ -865,7 +2179,7 @@ cuplaMemcpy3DAsync(
             );
 
             ::alpaka::mem::view::copy(
-                streamObject,
+                *streamObject,
                 dView,
                 cupla::DeviceViewWrapper< 3u >(
                     dSrcBuf,
@@ -878,55 +2192,25 @@ cuplaMemcpy3DAsync(
         }
         break;
         case cuplaMemcpyHostToHost:
-        {
-            auto& hostStreamObject(
-                cupla::manager::Stream<
-                    cupla::AccHost,
-                    cupla::AccHostStream
-                >::get().stream( stream )
-            );
-
-            auto& host(
-                cupla::manager::Device<
-                    cupla::AccHost
-                >::get().current()
-            );
-            cupla::HostBufWrapper< 3u > hSrcBuf(
-                const_cast<uint8_t *>(
-                    static_cast<const uint8_t *>(p->srcPtr.ptr)
-                ),
-                host,
-                extentSrc,
-                srcPitch
-            );
-            cupla::HostBufWrapper< 3u > hDestBuf(
-                static_cast<uint8_t *>(
-                    p->dstPtr.ptr
-                ),
-                host,
-                extentDst,
-                dstPitch
-            );
-
-            cupla::HostViewWrapper< 3u > hView(
-                hDestBuf,
-                extentDst - offsetDst,
-                offsetDst
-            );
-            ::alpaka::mem::view::copy(
-                hostStreamObject,
-                hView,
-                cupla::HostViewWrapper< 3u >(
-                    hSrcBuf,
-                    extentSrc - offsetSrc,
-                    offsetSrc
-                ),
-                numBytes
+            // executed by the host in order with the work of the stream
+            ::alpaka::stream::enqueue(
+                *streamObject,
+                hostCopy3DTask(
+                    dst,
+                    p->dstPtr.pitch,
+                    dstSlicePitch,
+                    src,
+                    p->srcPtr.pitch,
+                    srcSlicePitch,
+                    p->extent
+                )
             );
-
-        }
+        break;
+        case cuplaMemcpyDefault:
+            // already resolved by resolveMemcpyKind()
         break;
     }
+#endif
     return cuplaSuccess;
 }
 
@@ -935,17 +2219,20 @@ cuplaMemcpy3D(
     const cupla::Memcpy3DParms * const p
 )
 {
-    cuplaDeviceSynchronize();
+    cupla::manager::Stream<
+        cupla::AccDev,
+        cupla::AccStream
+    >::get().waitForBlockingStreams( );
 
-    cuplaMemcpy3DAsync( p, 0 );
+    cuplaError_t const err = cuplaMemcpy3DAsync( p, 0 );
 
     auto& streamObject(
-        cupla::manager::Stream<
+        *cupla::manager::Stream<
             cupla::AccDev,
             cupla::AccStream
         >::get().stream( 0 )
     );
     ::alpaka::wait::wait( streamObject );
 
-    return cuplaSuccess;
+    return err;
 }
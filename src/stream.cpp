@@ -42,18 +42,119 @@ cuplaStreamCreate(
     return cuplaSuccess;
 };
 
+cuplaError_t
+cuplaStreamCreateWithFlags(
+    cuplaStream_t * stream,
+    unsigned int flags
+)
+{
+    if( flags & ~static_cast< unsigned int >( cuplaStreamNonBlocking ) )
+        return cuplaErrorInvalidValue;
+
+    *stream = cupla::manager::Stream<
+        cupla::AccDev,
+        cupla::AccStream
+    >::get().create( flags );
+
+    return cuplaSuccess;
+};
+
+cuplaError_t
+cuplaStreamGetFlags(
+    cuplaStream_t stream,
+    unsigned int * flags
+)
+{
+    if( flags == nullptr )
+        return cuplaErrorInvalidValue;
+
+    auto const * const entry = cupla::manager::Stream<
+        cupla::AccDev,
+        cupla::AccStream
+    >::get().entry( stream );
+    if( entry == nullptr )
+        return cuplaErrorInvalidResourceHandle;
+
+    *flags = entry->flags;
+
+    return cuplaSuccess;
+};
+
+cuplaError_t
+cuplaStreamCreateWithPriority(
+    cuplaStream_t * stream,
+    unsigned int flags,
+    int priority
+)
+{
+    if( flags & ~static_cast< unsigned int >( cuplaStreamNonBlocking ) )
+        return cuplaErrorInvalidValue;
+
+    *stream = cupla::manager::Stream<
+        cupla::AccDev,
+        cupla::AccStream
+    >::get().create( flags, priority );
+
+    return cuplaSuccess;
+};
+
+cuplaError_t
+cuplaStreamGetPriority(
+    cuplaStream_t stream,
+    int * priority
+)
+{
+    if( priority == nullptr )
+        return cuplaErrorInvalidValue;
+
+    auto const * const entry = cupla::manager::Stream<
+        cupla::AccDev,
+        cupla::AccStream
+    >::get().entry( stream );
+    if( entry == nullptr )
+        return cuplaErrorInvalidResourceHandle;
+
+    *priority = entry->priority;
+
+    return cuplaSuccess;
+};
+
 cuplaError_t
 cuplaStreamDestroy( cuplaStream_t stream )
 {
+    auto& streamManager = cupla::manager::Stream<
+        cupla::AccDev,
+        cupla::AccStream
+    >::get();
+
+    // the default streams are owned by cupla
     if(
-        cupla::manager::Stream<
-            cupla::AccDev,
-            cupla::AccStream
-        >::get().destroy( stream )
+        stream == 0 ||
+        stream == cuplaStreamPerThread ||
+        streamManager.entry( stream ) == nullptr
     )
+        return cuplaErrorInvalidResourceHandle;
+
+    // memory released stream ordered is not bound to the stream anymore
+    cupla::manager::Memory<
+        cupla::AccDev,
+        cupla::AlpakaDim<1u>
+    >::get().releaseStream( stream );
+
+    cupla::manager::Memory<
+        cupla::AccDev,
+        cupla::AlpakaDim<2u>
+    >::get().releaseStream( stream );
+
+    cupla::manager::Memory<
+        cupla::AccDev,
+        cupla::AlpakaDim<3u>
+    >::get().releaseStream( stream );
+
+    if( streamManager.destroy( stream ) )
         return cuplaSuccess;
     else
-        return cuplaErrorInitializationError;
+        return cuplaErrorInvalidResourceHandle;
 };
 
 cuplaError_t
@@ -61,11 +162,14 @@ cuplaStreamSynchronize(
     cuplaStream_t stream
 )
 {
-    auto& streamObject = cupla::manager::Stream<
+    auto * const streamObject = cupla::manager::Stream<
         cupla::AccDev,
         cupla::AccStream
     >::get().stream( stream );
-    ::alpaka::wait::wait( streamObject );
+    if( streamObject == nullptr )
+        return cuplaErrorInvalidResourceHandle;
+
+    ::alpaka::wait::wait( *streamObject );
     return cuplaSuccess;
 }
 cuplaError_t
@@ -75,16 +179,18 @@ cuplaStreamWaitEvent(
     unsigned int
 )
 {
-    auto& streamObject = cupla::manager::Stream<
+    auto * const streamObject = cupla::manager::Stream<
         cupla::AccDev,
         cupla::AccStream
     >::get().stream( stream );
 
-    auto& eventObject = *cupla::manager::Event<
+    auto * const eventObject = cupla::manager::Event<
         cupla::AccDev,
         cupla::AccStream
     >::get().event( event );
+    if( streamObject == nullptr || eventObject == nullptr )
+        return cuplaErrorInvalidResourceHandle;
 
-    ::alpaka::wait::wait(streamObject,eventObject);
+    ::alpaka::wait::wait( *streamObject, **eventObject );
     return cuplaSuccess;
 }